@@ -0,0 +1,193 @@
+//*****************************************************************************
+// purpose: memory-mappable columnar file for Lab 1 records - see colfile.h
+// version: Fall 2024
+//*****************************************************************************
+#include "colfile.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include "lexer.h"
+#include "tokens.h"
+
+namespace
+{
+
+// Every token code a categorical column can hold
+const int kDictCodes[] = {
+  YES, NO, UNKNOWN_VALUE, MISSING, LABORATORY, PROBABLE, MALE, FEMALE, OTHER,
+  AGE_0X, AGE_1X, AGE_2X, AGE_4X, AGE_5X, AGE_6X, AGE_7X, AGE_8X,
+  HISPANIC, NATIVE_AMERICAN, ASIAN, BLACK, PACIFIC_ISLANDER, WHITE, MULTIPLE_OTHER,
+};
+const int kDictCount = sizeof(kDictCodes) / sizeof(kDictCodes[0]);
+
+uint64_t align_up( uint64_t n )
+{
+  return (n + kColFileAlign - 1) / kColFileAlign * kColFileAlign;
+}
+
+bool put( FILE* f, const void* p, size_t n, uint64_t& at )
+{
+  at += n;
+  return fwrite(p, 1, n, f) == n;
+}
+
+bool pad( FILE* f, uint64_t& at )
+{
+  static const char zeros[kColFileAlign] = { 0 };
+  return put(f, zeros, align_up(at) - at, at);
+}
+
+} // namespace
+
+void build_zones( const ColumnsView& cols, size_t blockRows, std::vector<ColFileZone>& zones )
+{
+  zones.assign((cols.rows + blockRows - 1) / blockRows, ColFileZone());
+  for (size_t b = 0; b < zones.size(); b++) {
+    size_t first = b * blockRows;
+    size_t last = first + blockRows < cols.rows ? first + blockRows : cols.rows;
+    for (int c = 0; c < kDateColumns; c++) {
+      int32_t lo = INT32_MAX, hi = INT32_MIN;
+      for (size_t r = first; r < last; r++) {
+        int32_t d = cols.date[c][r];
+        if (d == kNoDate) continue;
+        if (d < lo) lo = d;
+        if (d > hi) hi = d;
+      }
+      zones[b].min[c] = lo;
+      zones[b].max[c] = hi;
+    }
+  }
+}
+
+bool write_column_file( const char* path, const ColumnsView& cols, std::string& error )
+{
+  ColFileHeader h;
+  memset(&h, 0, sizeof h);
+  memcpy(h.magic, kColFileMagic, sizeof h.magic);
+  h.version = kColFileVersion;
+  h.byteOrder = 0x01020304;
+  h.rows = cols.rows;
+  h.columns = COL_COUNT;
+  h.dictEntries = kDictCount;
+  h.schemaOffset = align_up(sizeof h);
+  h.dictOffset = align_up(h.schemaOffset + COL_COUNT * sizeof(ColFileColumn));
+
+  std::vector<ColFileZone> zones;
+  build_zones(cols, kZoneRows, zones);
+  h.zoneOffset = align_up(h.dictOffset + kDictCount * sizeof(ColFileDictEntry));
+  h.zoneRows = kZoneRows;
+  h.zoneBlocks = (uint32_t)zones.size();
+
+  ColFileColumn schema[COL_COUNT];
+  memset(schema, 0, sizeof schema);
+  uint64_t offset = align_up(h.zoneOffset + zones.size() * sizeof(ColFileZone));
+  for (int c = 0; c < COL_COUNT; c++) {
+    strncpy(schema[c].name, column_name(c), sizeof schema[c].name - 1);
+    schema[c].type = c < kDateColumns ? COLTYPE_DATE : COLTYPE_CODE;
+    schema[c].width = c < kDateColumns ? 4 : 1;
+    schema[c].offset = offset;
+    schema[c].bytes = cols.rows * schema[c].width;
+    offset = align_up(offset + schema[c].bytes);
+  }
+
+  ColFileDictEntry dict[kDictCount];
+  memset(dict, 0, sizeof dict);
+  for (int i = 0; i < kDictCount; i++) {
+    dict[i].code = kDictCodes[i];
+    strncpy(dict[i].name, token_name(kDictCodes[i]), sizeof dict[i].name - 1);
+  }
+
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    error = std::string(path) + ": " + strerror(errno);
+    return false;
+  }
+  uint64_t at = 0;
+  bool ok = put(f, &h, sizeof h, at) && pad(f, at) &&
+            put(f, schema, sizeof schema, at) && pad(f, at) &&
+            put(f, dict, sizeof dict, at) && pad(f, at) &&
+            put(f, zones.data(), zones.size() * sizeof(ColFileZone), at) && pad(f, at);
+  for (int c = 0; ok && c < COL_COUNT; c++) {
+    const void* data = c < kDateColumns ? (const void*)cols.date[c]
+                                        : (const void*)cols.code[c - kDateColumns];
+    ok = put(f, data, schema[c].bytes, at) && pad(f, at);
+  }
+  if (fclose(f) != 0) ok = false;
+  if (!ok) error = std::string(path) + ": write failed";
+  return ok;
+}
+
+bool ColumnFile::open( const char* path, std::string& error )
+{
+  if (!file_.open(path)) {
+    error = std::string(path) + ": " + strerror(errno);
+    return false;
+  }
+  const char* base = file_.data();
+  uint64_t size = file_.size();
+  error = std::string(path) + ": ";
+
+  header_ = (const ColFileHeader*)base;
+  if (size < sizeof(ColFileHeader) || memcmp(header_->magic, kColFileMagic, 8) != 0) {
+    error += "not a column file";
+    return false;
+  }
+  if (header_->version < 1 || header_->version > kColFileVersion ||
+      header_->byteOrder != 0x01020304) {
+    error += "unsupported version or byte order";
+    return false;
+  }
+  if (header_->columns != COL_COUNT ||
+      header_->schemaOffset + COL_COUNT * sizeof(ColFileColumn) > size ||
+      header_->dictOffset + header_->dictEntries * sizeof(ColFileDictEntry) > size ||
+      header_->schemaOffset % kColFileAlign || header_->dictOffset % kColFileAlign) {
+    error += "bad schema";
+    return false;
+  }
+  zones_ = NULL;
+  if (header_->version >= 2 && header_->zoneOffset) {
+    uint64_t blocks = header_->zoneRows ? (header_->rows + header_->zoneRows - 1) / header_->zoneRows : 0;
+    if (!header_->zoneRows || header_->zoneBlocks != blocks ||
+        header_->zoneOffset % kColFileAlign || header_->zoneOffset > size ||
+        blocks * sizeof(ColFileZone) > size - header_->zoneOffset) {
+      error += "bad zone map";
+      return false;
+    }
+    zones_ = (const ColFileZone*)(base + header_->zoneOffset);
+  }
+  schema_ = (const ColFileColumn*)(base + header_->schemaOffset);
+  dict_ = (const ColFileDictEntry*)(base + header_->dictOffset);
+  for (uint32_t i = 0; i < header_->dictEntries; i++)
+    if (!memchr(dict_[i].name, 0, sizeof dict_[i].name)) {
+      error += "bad dictionary";
+      return false;
+    }
+
+  view_.rows = header_->rows;
+  for (int c = 0; c < COL_COUNT; c++) {
+    const ColFileColumn& col = schema_[c];
+    uint32_t type = c < kDateColumns ? COLTYPE_DATE : COLTYPE_CODE;
+    uint32_t width = c < kDateColumns ? 4 : 1;
+    if (col.type != type || col.width != width || col.bytes != view_.rows * width ||
+        col.offset % kColFileAlign || col.offset > size || col.bytes > size - col.offset ||
+        strncmp(col.name, column_name(c), sizeof col.name) != 0) {
+      error += "bad column ";
+      error += column_name(c);
+      return false;
+    }
+    if (c < kDateColumns)
+      view_.date[c] = (const int32_t*)(base + col.offset);
+    else
+      view_.code[c - kDateColumns] = (const uint8_t*)(base + col.offset);
+  }
+  error.clear();
+  return true;
+}
+
+const char* ColumnFile::code_name( int code ) const
+{
+  for (uint32_t i = 0; i < header_->dictEntries; i++)
+    if ((int)dict_[i].code == code) return dict_[i].name;
+  return "?";
+}
@@ -0,0 +1,114 @@
+//*****************************************************************************
+// purpose: memory-mappable columnar file for Lab 1 records
+// version: Fall 2024
+//
+// Layout (all integers little-endian, every section 64-byte aligned):
+//
+//   ColFileHeader       magic "LAB1COLS", version, row and column counts,
+//                       section offsets
+//   ColFileColumn[n]    schema: name, type, element width, offset, bytes
+//   ColFileDictEntry[k] token code -> name for the categorical columns
+//   ColFileZone[b]      zone map: min and max day of each date column in
+//                       each block of zoneRows rows (version 2)
+//   column 0 data ... column n-1 data
+//
+// The column arrays are written exactly as RecordColumns holds them, so a
+// reader maps the file and points a ColumnsView at it. Nothing is parsed.
+//
+// The zone map lets a date range query (query.h) skip every block whose
+// dates cannot match without reading its rows: 32 bytes per 8192 rows.
+// It pays off when the rows are roughly in date order, as appended daily
+// extracts are. Version 1 files have no zone map and are scanned whole.
+//*****************************************************************************
+#ifndef COLFILE_H
+#define COLFILE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "mapfile.h"
+#include "records.h"
+
+const char     kColFileMagic[8]  = { 'L', 'A', 'B', '1', 'C', 'O', 'L', 'S' };
+const uint32_t kColFileVersion   = 2;
+const uint32_t kColFileAlign     = 64;
+const uint32_t kZoneRows         = 8192;   // rows per zone map block
+
+enum ColType
+{
+  COLTYPE_DATE = 1,  // int32 days since 1970-01-01, kNoDate when empty
+  COLTYPE_CODE = 2,  // uint8 token code (lexer.h), kNoCode when empty
+};
+
+struct ColFileHeader
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t byteOrder;     // 0x01020304 as written
+  uint64_t rows;
+  uint32_t columns;
+  uint32_t dictEntries;
+  uint64_t schemaOffset;
+  uint64_t dictOffset;
+  uint64_t zoneOffset;    // 0: no zone map (version 1)
+  uint32_t zoneRows;      // rows per block
+  uint32_t zoneBlocks;    // ceil(rows / zoneRows)
+};
+
+struct ColFileColumn
+{
+  char     name[24];      // NUL-terminated
+  uint32_t type;          // ColType
+  uint32_t width;         // bytes per row
+  uint64_t offset;        // from the start of the file
+  uint64_t bytes;         // rows * width
+};
+
+struct ColFileDictEntry
+{
+  uint32_t code;
+  char     name[28];      // NUL-terminated
+};
+
+// Days in one block of rows, by date column; min > max when the column is
+// empty in every row of the block
+struct ColFileZone
+{
+  int32_t  min[kDateColumns];
+  int32_t  max[kDateColumns];
+};
+
+// Zone map of `cols`, one entry per `blockRows` rows
+void build_zones( const ColumnsView& cols, size_t blockRows, std::vector<ColFileZone>& zones );
+
+// Write `cols` to `path`; false with `error` set on failure
+bool write_column_file( const char* path, const ColumnsView& cols, std::string& error );
+
+// A mapped column file
+class ColumnFile
+{
+public:
+  // Map and validate `path`; false with `error` set on failure
+  bool open( const char* path, std::string& error );
+
+  const ColumnsView&     view() const { return view_; }
+  const ColFileHeader&   header() const { return *header_; }
+  const ColFileColumn*   schema() const { return schema_; }
+  const ColFileDictEntry* dictionary() const { return dict_; }
+  const ColFileZone*     zones() const { return zones_; }   // NULL if none
+  size_t                 zoneRows() const { return header_->zoneRows; }
+  size_t                 zoneBlocks() const { return zones_ ? header_->zoneBlocks : 0; }
+
+  // Name of a token code from the file's dictionary ("?" if absent)
+  const char* code_name( int code ) const;
+
+private:
+  MappedFile              file_;
+  const ColFileHeader*    header_;
+  const ColFileColumn*    schema_;
+  const ColFileDictEntry* dict_;
+  const ColFileZone*      zones_;
+  ColumnsView             view_;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+# Lab 1 corpus test — generates a synthetic CSV with gencsv (fixture quirks
+# plus malformed rows), then for each engine checks that `lex --count`
+# prints exactly the counts gencsv expects, and reports MB/s. --records
+# must reject exactly the malformed rows. A second, smaller corpus with
+# unknown tokens checks the error output, and that --resync drops exactly
+# the rows with unknown tokens.
+#
+# Usage: ./corpus_test.sh [MEGABYTES] [SEED] [MALFORMED_FRACTION]
+#   ENGINES="--simd --threads=4" overrides the engines tried (the flex
+#   scanner is "" and is tried by default)
+
+set -uo pipefail
+
+MB="${1:-256}"
+SEED="${2:-1}"
+BAD="${3:-0.01}"
+ENGINES="${ENGINES:-"'' --simd --threads=$(nproc)"}"
+
+make -s lex gencsv || exit 2
+
+TMP="$(mktemp -d)"; trap 'rm -rf "$TMP"' EXIT
+CSV="$TMP/corpus.csv"
+summary=$(./gencsv --size="${MB}M" --seed="$SEED" --malformed="$BAD" \
+                   --expected="$TMP/expected" -o "$CSV" 2>&1) || exit 2
+SIZE=$(stat -c %s "$CSV")
+MALFORMED=$(awk '{ print $4 }' <<< "$summary")
+echo "corpus: $summary"
+
+fail=0
+eval "set -- $ENGINES"
+for engine in "$@"; do
+  name="${engine:-flex}"
+  start=$(date +%s.%N)
+  ./lex $engine --count "$CSV" | tail -n +2 > "$TMP/got"
+  end=$(date +%s.%N)
+  if cmp -s "$TMP/got" "$TMP/expected"; then result=ok; else result=FAIL; fail=1; fi
+  awk -v n="$name" -v s="$start" -v e="$end" -v b="$SIZE" -v r="$result" \
+    'BEGIN { printf "  %-14s %7.3f s  %8.1f MB/s  %s\n", n, e - s, b / (e - s) / 1e6, r }'
+  [[ $result == ok ]] || diff "$TMP/expected" "$TMP/got" | head -20
+done
+
+rejected=$(./lex --records "$CSV" | awk '/^rows:/ { print $4 }')
+if [[ "$rejected" == "$MALFORMED" ]]; then
+  echo "  records        rejected $rejected of $MALFORMED malformed  ok"
+else
+  echo "  records        rejected $rejected of $MALFORMED malformed  FAIL"; fail=1
+fi
+
+./gencsv --rows=20000 --seed="$SEED" --unknown=0.01 --expected="$TMP/expected" \
+         --expected-resync="$TMP/resync" -o "$TMP/unknown.csv" 2> /dev/null
+for engine in "$@"; do
+  ./lex $engine --count "$TMP/unknown.csv" | tail -n +2 > "$TMP/got"
+  if ! cmp -s "$TMP/got" "$TMP/expected"; then
+    echo "  ${engine:-flex}: unknown token output differs"; fail=1
+    diff "$TMP/expected" "$TMP/got" | head
+  fi
+  ./lex $engine --resync --count "$TMP/unknown.csv" | tail -n +2 > "$TMP/got"
+  if ! cmp -s "$TMP/got" "$TMP/resync"; then
+    echo "  ${engine:-flex}: --resync output differs"; fail=1
+    diff "$TMP/resync" "$TMP/got" | head
+  fi
+done
+
+if [[ $fail -eq 0 ]]; then echo "PASS"; else echo "FAIL"; fi
+exit $fail
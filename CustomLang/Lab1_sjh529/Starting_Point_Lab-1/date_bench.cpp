@@ -0,0 +1,99 @@
+//*****************************************************************************
+// purpose: throughput benchmark for Lab 1 date decoding (dates.h)
+// version: Fall 2024
+//
+//   date_bench [dates] [runs]
+//
+// 1. Decodes `dates` random lexemes (1 in 16 invalid, e.g. 2020/13/45 or
+//    2021/02/29) with parse_dates() and with parse_date() one at a time,
+//    checks that both agree, and prints Mdates/s.
+// 2. Builds records from a date-heavy synthetic CSV (every date column
+//    filled) and prints MB/s of CSV.
+// Set DATES_ISA=scalar|ssse3|avx2 to pick the parse_dates implementation.
+//*****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <time.h>
+#include <vector>
+#include "dates.h"
+#include "records.h"
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void random_date( char* out, unsigned& seed )
+{
+  seed = seed * 1103515245 + 12345;
+  unsigned r = seed >> 8;
+  int y = 2019 + r % 6, m = 1 + (r >> 3) % 12, d = 1 + (r >> 7) % 28;
+  if ((r >> 12) % 16 == 0) {           // invalid on purpose
+    if (r & 1) m = 13 + (r >> 16) % 87;
+    else { y = 2021; m = 2; d = 29; }
+  }
+  snprintf(out, 11, "%04d/%02d/%02d", y, m, d);
+}
+
+int main( int argc, char* argv[] )
+{
+  size_t n = argc > 1 ? atol(argv[1]) : 10000000;
+  int runs = argc > 2 ? atoi(argv[2]) : 5;
+
+  // 1. parse_dates vs parse_date
+  std::vector<char> text(n * 10 + 1);
+  std::vector<const char*> ptrs(n);
+  unsigned seed = 1;
+  for (size_t i = 0; i < n; i++) {
+    random_date(&text[i * 10], seed);
+    ptrs[i] = &text[i * 10];
+  }
+  std::vector<int32_t> days(n), check(n);
+  double best = 0, bestOne = 0;
+  size_t bad = 0;
+  for (int r = 0; r < runs; r++) {
+    double t0 = seconds();
+    bad = parse_dates(ptrs.data(), n, days.data());
+    double t1 = seconds();
+    for (size_t i = 0; i < n; i++) check[i] = parse_date(ptrs[i]);
+    double t2 = seconds();
+    if (r == 0 || t1 - t0 < best) best = t1 - t0;
+    if (r == 0 || t2 - t1 < bestOne) bestOne = t2 - t1;
+  }
+  for (size_t i = 0; i < n; i++)
+    if (days[i] != check[i]) {
+      printf("MISMATCH at %zu: %.10s %d vs %d\n", i, ptrs[i], days[i], check[i]);
+      return 1;
+    }
+  printf("parse_dates (%s): %zu dates, %zu invalid, %.1f Mdates/s\n",
+      dates_isa(), n, bad, n / best / 1e6);
+  printf("parse_date loop:    %.1f Mdates/s\n", n / bestOne / 1e6);
+
+  // 2. date-heavy CSV through the record builder
+  std::string csv;
+  size_t rows = n / 4;
+  char d[4][11];
+  for (size_t i = 0; i < rows; i++) {
+    for (int c = 0; c < 4; c++) random_date(d[c], seed);
+    csv += d[0]; csv += ','; csv += d[1]; csv += ','; csv += d[2]; csv += ',';
+    csv += d[3];
+    csv += ",Laboratory-confirmed case,Female,20 - 39 Years,Unknown,No,No,No,Missing\n";
+  }
+  best = 0;
+  RecordStats stats;
+  size_t kept = 0;
+  for (int r = 0; r < runs; r++) {
+    RecordColumns cols;
+    double t0 = seconds();
+    stats = build_records(csv.data(), csv.data() + csv.size(), cols);
+    double t = seconds() - t0;
+    kept = cols.rows();
+    if (r == 0 || t < best) best = t;
+  }
+  printf("records: %zu bytes, %zu rows kept, %ld rejected (%ld for dates), %.1f MB/s\n",
+      csv.size(), kept, stats.rejected, stats.badDates, csv.size() / best / 1e6);
+  return 0;
+}
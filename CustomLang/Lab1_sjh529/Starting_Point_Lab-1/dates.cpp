@@ -0,0 +1,177 @@
+//*****************************************************************************
+// purpose: DATE lexeme decoding and validation for Lab 1 - see dates.h
+// version: Fall 2024
+//*****************************************************************************
+#include "dates.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DATES_X86 1
+#endif
+
+int32_t days_from_civil( int y, int m, int d )
+{
+  // H. Hinnant's algorithm: March-based years make Feb 29 the last day
+  y -= m <= 2;
+  int era = (y >= 0 ? y : y - 399) / 400;   // year 0000 Jan/Feb gives y = -1
+  int yoe = y - era * 400;
+  int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+namespace
+{
+
+inline int32_t checked_days( int y, int m, int d )
+{
+  static const unsigned char kMonthDays[13] = { 0, 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  if (m < 1 || m > 12 || d < 1 || d > kMonthDays[m]) return kBadDate;
+  if (m == 2 && d == 29 && (y % 4 != 0 || (y % 100 == 0 && y % 400 != 0))) return kBadDate;
+  return days_from_civil(y, m, d);
+}
+
+inline bool is_digit( char c ) { return c >= '0' && c <= '9'; }
+
+size_t parse_scalar( const char* const* texts, size_t n, int32_t* days )
+{
+  size_t bad = 0;
+  for (size_t i = 0; i < n; i++) {
+    days[i] = parse_date(texts[i]);
+    bad += days[i] == kBadDate;
+  }
+  return bad;
+}
+
+#ifdef DATES_X86
+// Bits of the movemask for a well-formed lane: digits at 0-3, 5-6, 8-9 and
+// '/' at 4 and 7
+const int kDigitBits = 0x36F;
+const int kSlashBits = 0x090;
+
+// 16 lanes at a time: copy the lexemes into lanes, then decode
+const size_t kBatch = 16;
+
+__attribute__((target("ssse3")))
+size_t parse_ssse3( const char* const* texts, size_t n, int32_t* days )
+{
+  const __m128i zero  = _mm_set1_epi8('0');
+  const __m128i nine  = _mm_set1_epi8(9);
+  const __m128i slash = _mm_set1_epi8('/');
+  // byte pairs -> 16-bit: Y1Y2, Y3Y4, M1*10, M2, D1D2
+  const __m128i w8  = _mm_setr_epi8(10, 1, 10, 1, 0, 10, 1, 0, 10, 1, 0, 0, 0, 0, 0, 0);
+  // 16-bit pairs -> 32-bit: year, month, day
+  const __m128i w16 = _mm_setr_epi16(100, 1, 1, 1, 1, 0, 0, 0);
+
+  char lanes[kBatch][16] = {};   // bytes 10-15 of each lane stay zero
+  size_t bad = 0;
+  for (size_t base = 0; base < n; base += kBatch) {
+    size_t k = n - base < kBatch ? n - base : kBatch;
+    for (size_t i = 0; i < k; i++) memcpy(lanes[i], texts[base + i], 10);
+    for (size_t i = 0; i < k; i++) {
+      __m128i v = _mm_loadu_si128((const __m128i*)lanes[i]);
+      __m128i d = _mm_sub_epi8(v, zero);
+      int digits = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(d, nine), d));
+      int slashes = _mm_movemask_epi8(_mm_cmpeq_epi8(v, slash));
+      __m128i ymd = _mm_madd_epi16(_mm_maddubs_epi16(d, w8), w16);
+      int32_t r = kBadDate;
+      if ((digits & kDigitBits) == kDigitBits && (slashes & kSlashBits) == kSlashBits)
+        r = checked_days(_mm_cvtsi128_si32(ymd),
+                         _mm_cvtsi128_si32(_mm_srli_si128(ymd, 4)),
+                         _mm_cvtsi128_si32(_mm_srli_si128(ymd, 8)));
+      days[base + i] = r;
+      bad += r == kBadDate;
+    }
+  }
+  return bad;
+}
+
+__attribute__((target("avx2")))
+size_t parse_avx2( const char* const* texts, size_t n, int32_t* days )
+{
+  const __m256i zero  = _mm256_set1_epi8('0');
+  const __m256i nine  = _mm256_set1_epi8(9);
+  const __m256i slash = _mm256_set1_epi8('/');
+  const __m256i w8  = _mm256_setr_epi8(10, 1, 10, 1, 0, 10, 1, 0, 10, 1, 0, 0, 0, 0, 0, 0,
+                                       10, 1, 10, 1, 0, 10, 1, 0, 10, 1, 0, 0, 0, 0, 0, 0);
+  const __m256i w16 = _mm256_setr_epi16(100, 1, 1, 1, 1, 0, 0, 0, 100, 1, 1, 1, 1, 0, 0, 0);
+
+  char lanes[kBatch][16] = {};   // bytes 10-15 of each lane stay zero
+  size_t bad = 0;
+  for (size_t base = 0; base < n; base += kBatch) {
+    size_t k = n - base < kBatch ? n - base : kBatch;
+    for (size_t i = 0; i < k; i++) memcpy(lanes[i], texts[base + i], 10);
+    for (size_t i = 0; i < k; i += 2) {
+      __m256i v = _mm256_loadu_si256((const __m256i*)lanes[i]);
+      __m256i d = _mm256_sub_epi8(v, zero);
+      unsigned digits = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(d, nine), d));
+      unsigned slashes = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, slash));
+      __m256i ymd = _mm256_madd_epi16(_mm256_maddubs_epi16(d, w8), w16);
+      int32_t out[8];
+      _mm256_storeu_si256((__m256i*)out, ymd);
+      for (size_t j = 0; j < 2 && i + j < k; j++) {   // odd k: spare lane ignored
+        unsigned dj = digits >> (16 * j), sj = slashes >> (16 * j);
+        int32_t r = kBadDate;
+        if ((dj & kDigitBits) == (unsigned)kDigitBits && (sj & kSlashBits) == (unsigned)kSlashBits)
+          r = checked_days(out[4 * j], out[4 * j + 1], out[4 * j + 2]);
+        days[base + i + j] = r;
+        bad += r == kBadDate;
+      }
+    }
+  }
+  return bad;
+}
+#endif
+
+struct Impl
+{
+  const char* name;
+  size_t (*fn)( const char* const*, size_t, int32_t* );
+};
+
+Impl pick_impl()
+{
+  const char* want = getenv("DATES_ISA");
+  Impl scalar = { "scalar", parse_scalar };
+  if (want && !strcmp(want, "scalar")) return scalar;
+#ifdef DATES_X86
+  __builtin_cpu_init();
+  Impl ssse3 = { "ssse3", parse_ssse3 };
+  Impl avx2 = { "avx2", parse_avx2 };
+  if (want && !strcmp(want, "ssse3") && __builtin_cpu_supports("ssse3")) return ssse3;
+  if (__builtin_cpu_supports("avx2")) return avx2;
+  if (__builtin_cpu_supports("ssse3")) return ssse3;
+#endif
+  return scalar;
+}
+
+const Impl& impl()
+{
+  static const Impl i = pick_impl();
+  return i;
+}
+
+} // namespace
+
+int32_t parse_date( const char* s )
+{
+  for (int i = 0; i < 10; i++)
+    if (i == 4 || i == 7 ? s[i] != '/' : !is_digit(s[i])) return kBadDate;
+  int y = (s[0] - '0') * 1000 + (s[1] - '0') * 100 + (s[2] - '0') * 10 + (s[3] - '0');
+  int m = (s[5] - '0') * 10 + (s[6] - '0');
+  int d = (s[8] - '0') * 10 + (s[9] - '0');
+  return checked_days(y, m, d);
+}
+
+size_t parse_dates( const char* const* texts, size_t n, int32_t* days )
+{
+  return impl().fn(texts, n, days);
+}
+
+const char* dates_isa()
+{
+  return impl().name;
+}
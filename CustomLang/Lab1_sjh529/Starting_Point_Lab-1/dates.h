@@ -0,0 +1,38 @@
+//*****************************************************************************
+// purpose: DATE lexeme decoding and validation for Lab 1
+// version: Fall 2024
+//
+// The flex rule {YEAR}"/"{MONTH}"/"{DAY} accepts any digits (2020/13/45).
+// These functions turn a "YYYY/MM/DD" lexeme into days since 1970-01-01
+// and return kBadDate unless it names a real day of the proleptic
+// Gregorian calendar (month 1-12, day 1 up to the month's length).
+//
+// parse_dates() decodes many fields at once. Each lexeme is copied into a
+// 16-byte lane. The digits are checked and combined into year, month and
+// day with two multiply-add instructions per lane (SSSE3, or two lanes per
+// instruction with AVX2). The calendar check and day count run on the
+// extracted values. DATES_ISA=scalar|ssse3|avx2 forces one implementation
+// (for benchmarks).
+//*****************************************************************************
+#ifndef DATES_H
+#define DATES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+const int32_t kBadDate = INT32_MIN + 1;   // not a calendar date
+
+// Days from 1970-01-01 to y-m-d (no validation)
+int32_t days_from_civil( int y, int m, int d );
+
+// One "YYYY/MM/DD" lexeme (10 readable bytes); kBadDate if invalid
+int32_t parse_date( const char* s );
+
+// Decode n lexemes; days[i] gets the day number or kBadDate.
+// Returns the number of invalid dates.
+size_t parse_dates( const char* const* texts, size_t n, int32_t* days );
+
+// Name of the parse_dates implementation in use ("avx2", "ssse3", "scalar")
+const char* dates_isa();
+
+#endif
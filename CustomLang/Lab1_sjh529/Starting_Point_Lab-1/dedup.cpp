@@ -0,0 +1,187 @@
+//*****************************************************************************
+// purpose: duplicate row detection for Lab 1 - see dedup.h
+// version: Fall 2024
+//*****************************************************************************
+#include "dedup.h"
+
+#include <string.h>
+#include "dates.h"
+#include "parallel.h"
+
+const int kFirstBits = 16;      // initial table: 64K slots
+const int kDistanceBits = 8;    // a slot's distance from home + 1, 0 if empty
+const uint64_t kDistanceMask = (1u << kDistanceBits) - 1;
+const unsigned kMaxDistance = kDistanceMask - 1;
+
+// Slot i of a table of `width`-bit slots; a slot may straddle two words
+static inline uint64_t slot_get( const std::vector<uint64_t>& words, int width, size_t i )
+{
+  size_t bit = i * width;
+  const uint64_t* w = &words[bit >> 6];
+  unsigned off = bit & 63;
+  uint64_t v = w[0] >> off;
+  if (off + width > 64) v |= w[1] << (64 - off);
+  return v & ((1ull << width) - 1);
+}
+
+static inline void slot_put( std::vector<uint64_t>& words, int width, size_t i, uint64_t v )
+{
+  size_t bit = i * width;
+  uint64_t* w = &words[bit >> 6];
+  unsigned off = bit & 63;
+  uint64_t m = (1ull << width) - 1;
+  w[0] = (w[0] & ~(m << off)) | (v << off);
+  if (off + width > 64)
+    w[1] = (w[1] & ~(m >> (64 - off))) | (v >> (64 - off));
+}
+
+RowSet::RowSet()
+  : bits_(0), width_(0), count_(0)
+{
+  rebuild(kFirstBits);
+}
+
+bool RowSet::insert( uint64_t hash )
+{
+  size_t mask = ((size_t)1 << bits_) - 1;
+  size_t i = hash >> (64 - bits_);
+  uint64_t rest = hash & (~0ull >> bits_);
+  // rows are kept in order of home slot (Robin Hood), so the hash can only
+  // be among the slots whose rows are at least as far from home as it
+  unsigned dist = 1;
+  for (; ; i = (i + 1) & mask, dist++) {
+    uint64_t s = slot_get(words_, width_, i);
+    if ((s & kDistanceMask) < dist) break;   // also an empty slot
+    if (s == (rest << kDistanceBits | dist)) return false;
+  }
+  if (!spilled_.empty() && spilled_.count(hash)) return false;
+  uint64_t spill;
+  if (!place(i, dist, rest, spill)) spilled_.insert(spill);
+  if (++count_ * 8 > (size_t)7 << bits_) rebuild(bits_ + 1);
+  return true;
+}
+
+// Put a row that is not in the table into slot i, `dist` - 1 slots from
+// its home, or further on: a row nearer its home gives its slot up and
+// moves on instead. False if some row would get further than kMaxDistance
+// from home; it is left out and its hash returned in `spill`.
+bool RowSet::place( size_t i, unsigned dist, uint64_t rest, uint64_t& spill )
+{
+  size_t mask = ((size_t)1 << bits_) - 1;
+  for (; ; i = (i + 1) & mask, dist++) {
+    if (dist > kMaxDistance + 1) {
+      size_t home = (i - (dist - 1)) & mask;
+      spill = (uint64_t)home << (64 - bits_) | rest;
+      return false;
+    }
+    uint64_t s = slot_get(words_, width_, i);
+    unsigned d = s & kDistanceMask;
+    if (d < dist) {
+      slot_put(words_, width_, i, rest << kDistanceBits | dist);
+      if (!d) return true;
+      rest = s >> kDistanceBits;
+      dist = d;
+    }
+  }
+}
+
+// Move every row to a table of 1 << bits slots; a row's hash is its home
+// slot followed by its stored remainder
+void RowSet::rebuild( int bits )
+{
+  std::vector<uint64_t> old;
+  std::unordered_set<uint64_t> oldSpilled;
+  old.swap(words_);
+  oldSpilled.swap(spilled_);
+  int oldBits = bits_, oldWidth = width_;
+  size_t oldMask = ((size_t)1 << oldBits) - 1;
+
+  bits_ = bits;
+  width_ = 64 - bits + kDistanceBits;
+  words_.assign((((size_t)width_ << bits) + 63) / 64 + 1, 0);
+  auto add = [&](uint64_t hash) {
+    uint64_t spill;
+    if (!place(hash >> (64 - bits), 1, hash & (~0ull >> bits), spill))
+      spilled_.insert(spill);
+  };
+  for (size_t i = 0; !old.empty() && i <= oldMask; i++) {
+    uint64_t s = slot_get(old, oldWidth, i);
+    if (!s) continue;
+    uint64_t home = (i - ((s & kDistanceMask) - 1)) & oldMask;
+    add(home << (64 - oldBits) | s >> kDistanceBits);
+  }
+  for (uint64_t hash : oldSpilled) add(hash);
+}
+
+uint64_t token_key( const ScanToken& tok )
+{
+  uint64_t v = (uint64_t)tok.code;
+  if (tok.code == DATE) {
+    int32_t day = parse_date(tok.text);
+    v |= (uint64_t)(uint32_t)day << 8;
+    if (day == kBadDate)   // keep 2020/13/45 and 2020/02/31 apart
+      for (int k = 0; k < tok.length; k++) v = hash_mix(v, (unsigned char)tok.text[k]);
+  }
+  else if (tok.code == UNKNOWN_TOKEN)
+    for (int k = 0; k < tok.length; k++) v = hash_mix(v, (unsigned char)tok.text[k] << 8);
+  return v;
+}
+
+void hash_rows( const char* begin, const char* end, int firstLine,
+                std::vector<RowHash>& rows )
+{
+  rows.clear();
+  FastScanner scanner(begin, end, firstLine);
+  ScanToken tok;
+  RowHash row;
+  const char* last = NULL;   // end of the row's last token, NULL between rows
+
+  auto close = [&]() {
+    const char* nl = (const char*)memchr(last, '\n', end - last);
+    row.end = nl ? nl + 1 : end;
+    row.hash = hash_finish(row.hash);
+    rows.push_back(row);
+  };
+
+  while (scanner.next(tok) != EOF_TOKEN) {
+    if (last && tok.line != row.line) {
+      close();
+      last = NULL;
+    }
+    if (!last) {
+      row.line = tok.line;
+      row.begin = tok.text;
+      while (row.begin > begin && row.begin[-1] != '\n') row.begin--;
+      row.hash = kHashSeed;
+    }
+    row.hash = hash_mix(row.hash, token_key(tok));
+    last = tok.text + tok.length;
+  }
+  if (last) close();
+}
+
+void dedup_parallel( const char* begin, const char* end, int threads,
+                     size_t chunkSize, int& line, RowSet& seen, bool report,
+                     DedupCounts& counts, FILE* out )
+{
+  std::vector<std::vector<RowHash> > hashed(chunk_slots(threads));
+
+  for_each_chunk(begin, end, threads, chunkSize, line,
+    [&](const ChunkRange& c) {
+      hash_rows(c.begin, c.end, c.firstLine, hashed[c.slot]);
+    },
+    [&](const ChunkRange& c) {
+      const std::vector<RowHash>& rows = hashed[c.slot];
+      for (size_t i = 0; i < rows.size(); i++) {
+        const RowHash& r = rows[i];
+        counts.rows++;
+        bool fresh = seen.insert(r.hash);
+        if (!fresh && !counts.duplicates++) counts.firstDuplicate = r.line;
+        if (!out || fresh == report) continue;
+        if (report) fprintf(out, "line %d: ", r.line);
+        fwrite(r.begin, 1, r.end - r.begin, out);
+        if (r.end[-1] != '\n') fputc('\n', out);
+      }
+      return true;
+    });
+}
@@ -0,0 +1,110 @@
+//*****************************************************************************
+// purpose: duplicate row detection for Lab 1 (lex --dedup[=report] [--count])
+// version: Fall 2024
+//
+// Daily extracts repeat rows. A row is identified by its normalized token
+// sequence: the token codes in order (separators included, so a value in
+// another column is another row), each DATE as its day number, and only
+// for unknown tokens the bytes themselves. "Yes" and "yes", or blanks
+// around a value, therefore do not make rows differ. The sequence is mixed
+// into a 64-bit hash as it is scanned.
+//
+// RowSet keeps only the hashes, in an open-addressing table of 2^b slots
+// kept at most 7/8 full. The top b bits of a hash name its home slot, so a
+// slot packs only the other 64 - b bits and its distance from home (linear
+// probing in Robin Hood order); a row too far from home goes to a side set
+// of whole hashes. A row whose hash equals a stored one is a duplicate, so
+// falseMatches() is n^2 / 2^65 for n distinct rows.
+//
+// dedup_parallel() hashes the rows of newline-aligned chunks on several
+// threads (parallel.h) and checks them against the set in input order, so
+// the first copy of a row is always the one kept.
+//*****************************************************************************
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unordered_set>
+#include <vector>
+#include "fastscan.h"
+
+// The pieces of the row hash, also used by the sketches (sketch.h):
+// token_key() is a token's normalized value, hash_mix() adds a value to a
+// hash, hash_finish() spreads it over all 64 bits
+uint64_t token_key( const ScanToken& tok );
+
+// two multiply/xor-shift rounds, so that values do not cancel each other
+inline uint64_t hash_mix( uint64_t h, uint64_t v )
+{
+  h = (h ^ v) * 0x9E3779B97F4A7C15ull;
+  h ^= h >> 29;
+  h *= 0xBF58476D1CE4E5B9ull;
+  return h ^ (h >> 32);
+}
+
+// MurmurHash3's finalizer: every bit of h affects the top bits
+inline uint64_t hash_finish( uint64_t h )
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  return h ^ (h >> 33);
+}
+
+const uint64_t kHashSeed = 0x2545F4914F6CDD1Dull;
+
+class RowSet
+{
+public:
+  RowSet();
+
+  // Add `hash`; false if it is already there
+  bool insert( uint64_t hash );
+
+  size_t size() const { return count_; }
+  size_t bytes() const { return words_.size() * sizeof(uint64_t) + spilled_.size() * 32; }
+  double falseMatches() const { return (double)count_ * count_ / 36893488147419103232.0; }
+
+private:
+  bool place( size_t i, unsigned dist, uint64_t rest, uint64_t& spill );
+  void rebuild( int bits );
+
+  std::vector<uint64_t>        words_;     // the slots, width_ bits each, back to back
+  int                          bits_;      // 1 << bits_ slots
+  int                          width_;     // remainder (64 - bits_) and distance bits
+  size_t                       count_;
+  std::unordered_set<uint64_t> spilled_;   // whole hashes of rows too far from home
+};
+
+// One row of the input with the hash of its normalized tokens
+struct RowHash
+{
+  uint64_t    hash;
+  const char* begin;   // the line, with its newline if it has one
+  const char* end;
+  int         line;
+};
+
+// Hash the rows (lines with at least one token) of [begin, end), which
+// starts on `firstLine`
+void hash_rows( const char* begin, const char* end, int firstLine,
+                std::vector<RowHash>& rows );
+
+struct DedupCounts
+{
+  long rows;
+  long duplicates;
+  int  firstDuplicate;   // line of the first duplicate, 0 if none
+};
+
+// Check the rows of [begin, end) against `seen` (see the top of this
+// file). Writes the rows that are new to `out`, or with `report` the
+// duplicates as "line N: row"; out may be NULL (--count).
+void dedup_parallel( const char* begin, const char* end, int threads,
+                     size_t chunkSize, int& line, RowSet& seen, bool report,
+                     DedupCounts& counts, FILE* out );
+
+#endif
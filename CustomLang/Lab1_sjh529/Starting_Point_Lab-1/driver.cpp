@@ -11,7 +11,30 @@
 #endif
 
 #include <stdio.h> // Comment
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "lexer.h"
+#include "fastscan.h"
+#include "tokens.h"
+#include "source.h"
+#include "parallel.h"
+#include "records.h"
+#include "colfile.h"
+#include "tally.h"
+#include "query.h"
+#include "resync.h"
+#include "ingest.h"
+#include "follow.h"
+#include "uringsource.h"
+#include "dedup.h"
+#include "sketch.h"
+#include <thread>
+#include <vector>
 
 extern "C"
 {
@@ -24,22 +47,15 @@ extern "C"
     extern int   line_number;  // the current line number
 }
 
-// Do the analysis
-int main( int argc, char* argv[] )
+// Tokenize with the flex scanner; tokens are printed, or counted into
+// `tally` when it is set (--quiet, --count, --histogram)
+int run_flex( const char* path, Tally* tally )
 {
   int token;   // hold each token code
-  char* token_str;  // point to the logical name of the token
+  int status = 0;
 
-  // Set the input stream
-  if (argc > 1) {
-    printf("INFO: Using the %s file for input\n", argv[1]);
-    yyin = fopen(argv[1], "r"); 
-  }
-  else {
-    printf("INFO: Using the sample.csv file for input\n");
-    yyin = fopen("sample.csv", "r");
-  }
-  
+  ChunkSource* src = open_source(path);
+  yyin = src ? source_fopen(src) : NULL;
   if (!yyin) {
     printf("ERROR: input file not found\n");
     return (-1);
@@ -57,58 +73,870 @@ int main( int argc, char* argv[] )
       break;
     }
 
-    // Determine the logical name of the lexeme
-    switch( token )
-    {
-      case DATE:             token_str = (char*)"DATE"; break;
-      case SEPARATOR:        token_str = (char*)"SEPARATOR"; break;
-      case YES:              token_str = (char*)"YES"; break;
-      case NO:               token_str = (char*)"NO"; break;
-      case UNKNOWN_VALUE:    token_str = (char*)"UNKNOWN_VALUE"; break;
-      case MISSING:          token_str = (char*)"MISSING"; break;
-
-      case LABORATORY:       token_str = (char*)"LABORATORY"; break;    
-      case PROBABLE:         token_str = (char*)"PROBABLE"; break;    
-
-      case MALE:             token_str = (char*)"MALE"; break;    
-      case FEMALE:           token_str = (char*)"FEMALE"; break;    
-      case OTHER:            token_str = (char*)"OTHER"; break;    
-
-      case AGE_0X:           token_str = (char*)"AGE_0X"; break;    
-      case AGE_1X:           token_str = (char*)"AGE_1X"; break;    
-      case AGE_2X:           token_str = (char*)"AGE_2X"; break;    
-      case AGE_4X:           token_str = (char*)"AGE_4X"; break;    
-      case AGE_5X:           token_str = (char*)"AGE_5X"; break;    
-      case AGE_6X:           token_str = (char*)"AGE_6X"; break;    
-      case AGE_7X:           token_str = (char*)"AGE_7X"; break;    
-      case AGE_8X:           token_str = (char*)"AGE_8X"; break;    
-
-      case HISPANIC:         token_str = (char*)"HISPANIC"; break;
-      case NATIVE_AMERICAN:  token_str = (char*)"NATIVE_AMERICAN"; break;    
-      case ASIAN:            token_str = (char*)"ASIAN"; break; 
-      case BLACK:            token_str = (char*)"BLACK"; break; 
-      case PACIFIC_ISLANDER: token_str = (char*)"PACIFIC_ISLANDER"; break; 
-      case WHITE:            token_str = (char*)"WHITE"; break; 
-      case MULTIPLE_OTHER:   token_str = (char*)"MULTIPLE_OTHER"; break; 
-      case EOF_TOKEN:        token_str = (char*)"EOF_TOKEN"; break;
-      case UNKNOWN_TOKEN:    token_str = (char*)"UNKNOWN_TOKEN"; break;
-
-      default:              token_str = (char*)"=== unmapped token name ===";
-    }
-
     // What did we find?
-    printf("line: %d  lexeme: |%s|  length: %d  token: %s\n", 
-        line_number, yytext, yyleng, token_str);
+    if ( !tally || token == UNKNOWN_TOKEN )
+      printf("line: %d  lexeme: |%s|  length: %d  token: %s\n", 
+          line_number, yytext, yyleng, token_name(token));
     
     // Is it an error?
     if( token == UNKNOWN_TOKEN ) {
       printf("ERROR: unknown token\n");
-      return(-2);
+      status = -2;
+      break;
     }
 
+    if ( tally )
+      tally->add(token, line_number);
+
     // Get the next token
     token = yylex();
   }
 
+  // closing the stream also deletes the source (source_fopen)
+  fclose(yyin);
+  yyin = NULL;
+  return(status);
+}
+
+// --follow[=SECONDS]: the SIMD runs read a FollowSource (follow.h)
+static bool   follow = false;
+static double followIdle = -1;
+
+// The input of run_simd, run_parallel and run_query
+static ChunkSource* open_input( const char* path )
+{
+  if (!follow) return open_source(path);
+  FollowSource* f = new FollowSource;
+  if (f->open(path, followIdle)) return f;
+  delete f;
+  return NULL;
+}
+
+// --follow: once the scan has caught up with the file, report how far it
+// got and the running totals (tokens are printed as they come)
+static void follow_progress( ChunkSource* src, int line, const Tally* tally,
+                             const QueryCounts* counts )
+{
+  FollowSource* f = dynamic_cast<FollowSource*>(src);
+  if (!f) return;
+  if (f->caughtUp() && tally)
+    printf("INFO: through line %d (byte %lld)  tokens: %ld\n", line - 1,
+           (long long)f->offset(), tally->total());
+  else if (f->caughtUp() && counts)
+    printf("INFO: through line %d (byte %lld)  rows: %ld  matched: %ld\n", line - 1,
+           (long long)f->offset(), counts->rows, counts->matched);
+  fflush(stdout);
+}
+
+// Print one token the way run_flex does
+void print_token( const ScanToken& tok )
+{
+  printf("line: %d  lexeme: |%.*s|  length: %d  token: %s\n",
+      tok.line, tok.length, tok.text, tok.length, token_name(tok.code));
+}
+
+// End of a run over `src`: report a read error (a corrupt .gz file) or
+// the end of the file, and free the source
+int finish_source( ChunkSource* src )
+{
+  std::string error = src->error();
+  delete src;
+  if (!error.empty()) {
+    printf("ERROR: %s\n", error.c_str());
+    return (-1);
+  }
+  printf("Found end of file...\n");
   return(0);
 }
+
+// --resync ran out of its --max-errors budget
+int give_up( const ErrorLog& errors )
+{
+  printf("ERROR: more than %ld bad lines, giving up on line %d\n", errors.budget, errors.lastLine);
+  return(-2);
+}
+
+// Tokenize with the SIMD engine (fastscan.h); same output as run_flex.
+// The input is scanned buffer by buffer as the source delivers it.
+// With `errors` (--resync) lines with unknown tokens are skipped.
+template <class Scanner>
+int scan_buffer( Scanner& scanner, Tally* tally, ErrorLog* errors )
+{
+  ScanToken tok;
+  while( scanner.next(tok) != EOF_TOKEN )
+  {
+    if( tok.code == UNKNOWN_TOKEN && errors )
+      return give_up(*errors);
+
+    if( !tally || tok.code == UNKNOWN_TOKEN )
+      print_token(tok);
+
+    if( tok.code == UNKNOWN_TOKEN ) {
+      printf("ERROR: unknown token\n");
+      return(-2);
+    }
+
+    if( tally )
+      tally->add(tok.code, tok.line);
+  }
+  return(0);
+}
+
+int run_simd( const char* path, Tally* tally, ErrorLog* errors )
+{
+  ChunkSource* src = open_input(path);
+  if (!src) {
+    printf("ERROR: input file not found\n");
+    return (-1);
+  }
+
+  int line = 1;
+  const char* begin;
+  const char* end;
+  while( src->next(begin, end) )
+  {
+    int status;
+    if( errors ) {
+      ResyncScanner scanner(begin, end, line, *errors);
+      status = scan_buffer(scanner, tally, errors);
+      line = scanner.line();
+    }
+    else {
+      FastScanner scanner(begin, end, line);
+      status = scan_buffer(scanner, tally, errors);
+      line = scanner.line();
+    }
+    if( status != 0 ) {
+      delete src;
+      return status;
+    }
+    follow_progress(src, line, tally, NULL);
+  }
+  return finish_source(src);
+}
+
+// Tokenize with the SIMD engine on several threads (parallel.h)
+int run_parallel( const char* path, int threads, size_t chunkSize, Tally* tally,
+                  ErrorLog* errors )
+{
+  ChunkSource* src = open_input(path);
+  if (!src) {
+    printf("ERROR: input file not found\n");
+    return (-1);
+  }
+
+  int line = 1;
+  const char* begin;
+  const char* end;
+  ScanToken unknown;
+  fflush(stdout);
+  while (src->next(begin, end)) {
+    int status = tally
+      ? tally_parallel(begin, end, threads, chunkSize, line, errors, *tally, unknown)
+      : tokenize_parallel(begin, end, threads, chunkSize, line, errors, stdout);
+    if (status == 0) {
+      follow_progress(src, line, tally, NULL);
+      continue;
+    }
+    if (errors)
+      status = give_up(*errors);
+    else if (tally) {
+      print_token(unknown);   // points into the source's buffer
+      printf("ERROR: unknown token\n");
+    }
+    delete src;
+    return status;
+  }
+  return finish_source(src);
+}
+
+// Print the rows that pass `query`, or with `count` only how many do.
+// Uses the SIMD engine (a row is skipped as soon as one test fails).
+// With `errors` (--resync) lines with unknown tokens are skipped.
+int run_query( const char* path, const Query& query, int threads,
+               size_t chunkSize, bool count, ErrorLog* errors )
+{
+  ChunkSource* src = open_input(path);
+  if (!src) {
+    printf("ERROR: input file not found\n");
+    return (-1);
+  }
+
+  QueryCounts counts = { 0, 0 };
+  int line = 1;
+  const char* begin;
+  const char* end;
+  fflush(stdout);
+  while (src->next(begin, end)) {
+    if (query_parallel(begin, end, threads, chunkSize, line, query, errors, counts,
+                       count ? NULL : stdout) != 0) {
+      delete src;
+      return give_up(*errors);
+    }
+    follow_progress(src, line, NULL, count ? &counts : NULL);
+  }
+  int status = finish_source(src);
+  if (status == 0 && count)
+    printf("rows: %ld  matched: %ld\n", counts.rows, counts.matched);
+  return status;
+}
+
+// Print every row once (the first copy), or with `report` only the rows
+// that repeat an earlier one, or with `count` just how many do (dedup.h).
+// Several files are checked as one stream, so a row repeated from an
+// earlier file is a duplicate; each file is announced with an INFO line.
+int run_dedup( const std::vector<std::string>& files, bool report, int threads,
+               size_t chunkSize, bool count )
+{
+  RowSet seen;
+  DedupCounts counts = { 0, 0, 0 };
+  std::string firstIn;
+  int status = 0;
+  for (size_t i = 0; i < files.size() && status == 0; i++) {
+    if (files.size() > 1)
+      printf("INFO: Using the %s file for input\n", files[i].c_str());
+    ChunkSource* src = open_input(files[i].c_str());
+    if (!src) {
+      printf("ERROR: input file not found\n");
+      return (-1);
+    }
+    long before = counts.duplicates;
+    int line = 1;
+    const char* begin;
+    const char* end;
+    fflush(stdout);
+    while (src->next(begin, end)) {
+      dedup_parallel(begin, end, threads, chunkSize, line, seen, report, counts,
+                     count ? NULL : stdout);
+      follow_progress(src, line, NULL, NULL);
+    }
+    if (!before && counts.duplicates && files.size() > 1) firstIn = " in " + files[i];
+    status = finish_source(src);
+  }
+  if (status == 0 && count) {
+    printf("rows: %ld  distinct: %zu  duplicates: %ld", counts.rows, seen.size(), counts.duplicates);
+    if (counts.duplicates)
+      printf("  (first%s on line %d)", firstIn.c_str(), counts.firstDuplicate);
+    printf("\nset: %zu bytes (%.1f per distinct row)  expected false duplicates: %.2g\n",
+           seen.bytes(), seen.size() ? (double)seen.bytes() / seen.size() : 0.0,
+           seen.falseMatches());
+  }
+  return status;
+}
+
+// Estimate distinct counts and draw a row sample in one pass (sketch.h),
+// and print them with their 95% error bounds
+int run_sketch( const char* path, const SketchSpec& spec, int threads, size_t chunkSize )
+{
+  ChunkSource* src = open_input(path);
+  if (!src) {
+    printf("ERROR: input file not found\n");
+    return (-1);
+  }
+  Sketches total(spec);
+  int line = 1;
+  const char* begin;
+  const char* end;
+  while (src->next(begin, end)) {
+    sketch_parallel(begin, end, threads, chunkSize, line, spec, total);
+    follow_progress(src, line, NULL, NULL);
+  }
+  int status = finish_source(src);
+  if (status != 0) return status;
+
+  printf("rows: %ld\n", total.rows);
+  double bound = 2 * HyperLogLog::relativeError();
+  for (size_t k = 0; k < spec.keys.size(); k++) {
+    double e = total.distinct[k].estimate();
+    printf("distinct %s: ~%.0f  (95%%: %.0f .. %.0f, +-%.1f%%; %zu bytes)\n",
+           spec.names[k].c_str(), e, e * (1 - bound), e * (1 + bound), bound * 100,
+           total.distinct[k].bytes());
+  }
+  if (spec.sample) {
+    std::vector<SampledRow> rows;
+    total.sample.rows(rows);
+    printf("sample: %zu of %ld rows (seed %llu)", rows.size(), total.rows,
+           (unsigned long long)spec.seed);
+    if (!rows.empty())
+      printf("; a share measured on it is within +-%.1f points (95%%)",
+             100 * 1.96 * sqrt(0.25 / rows.size()) *
+             (rows.size() < (size_t)total.rows
+                ? sqrt((total.rows - rows.size()) / (total.rows - 1.0)) : 0.0));
+    printf("\n");
+    for (size_t i = 0; i < rows.size(); i++)
+      printf("line %d: %s", rows[i].line, rows[i].text.c_str());
+  }
+  return 0;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Summarize typed columns: counts, size and one full pass over them
+void print_columns( const ColumnsView& cols )
+{
+  double t0 = seconds();
+  size_t filled[COL_COUNT] = { 0 };
+  for (int c = 0; c < kDateColumns; c++)
+    for (size_t r = 0; r < cols.rows; r++)
+      filled[c] += cols.date[c][r] != kNoDate;
+  for (int c = kDateColumns; c < COL_COUNT; c++)
+    for (size_t r = 0; r < cols.rows; r++)
+      filled[c] += cols.code[c - kDateColumns][r] != kNoCode;
+  double t1 = seconds();
+
+  printf("columns: %zu bytes (%d per row)\n", cols.bytes(), kDateColumns * 4 + COL_COUNT - kDateColumns);
+  printf("%-22s %s\n", "column", "filled");
+  for (int c = 0; c < COL_COUNT; c++)
+    printf("%-22s %zu\n", column_name(c), filled[c]);
+  printf("column scan: %.3f s  (%.2f GB/s of columns)\n", t1 - t0, cols.bytes() / (t1 - t0 + 1e-9) / 1e9);
+}
+
+// Feed the tokens of one buffer to `builder`; as scan_buffer()
+template <class Scanner>
+int build_buffer( Scanner& scanner, RecordBuilder& builder, ErrorLog* errors )
+{
+  ScanToken tok;
+  while (scanner.next(tok) != EOF_TOKEN) {
+    if (tok.code == UNKNOWN_TOKEN && errors)
+      return give_up(*errors);
+    builder.add(tok);
+  }
+  builder.finish();
+  return 0;
+}
+
+// Build the typed columns (records.h), optionally save them (colfile.h),
+// and summarize them; with `threads` > 0 on that many threads
+// (parallel.h). With `errors` (--resync) lines with unknown tokens are
+// skipped instead of rejected as rows.
+int run_records( const char* path, const char* saveTo, int threads, size_t chunkSize,
+                 ErrorLog* errors )
+{
+  ChunkSource* src = open_source(path);
+  if (!src) {
+    printf("ERROR: input file not found\n");
+    return (-1);
+  }
+
+  RecordColumns cols;
+  RecordBuilder builder(cols);
+  RecordStats stats = { 0, 0, 0 };
+  size_t size = 0;
+  int line = 1;
+  const char* begin;
+  const char* end;
+  double t0 = seconds();
+  fflush(stdout);
+  while (src->next(begin, end)) {
+    int status;
+    if (threads > 0) {
+      status = records_parallel(begin, end, threads, chunkSize, line, errors, cols, stats);
+      if (status != 0) status = give_up(*errors);
+    }
+    else if (errors) {
+      ResyncScanner scanner(begin, end, line, *errors);
+      status = build_buffer(scanner, builder, errors);
+      line = scanner.line();
+    }
+    else {
+      FastScanner scanner(begin, end, line);
+      status = build_buffer(scanner, builder, errors);
+      line = scanner.line();
+    }
+    if (status != 0) {
+      delete src;
+      return status;
+    }
+    size += end - begin;
+  }
+  if (threads <= 0) {
+    stats.rejected = builder.rejected();
+    stats.firstRejectedLine = builder.firstRejectedLine();
+    stats.badDates = builder.badDates();
+  }
+  double t1 = seconds();
+  std::string error = src->error();
+  delete src;
+  if (!error.empty()) {
+    printf("ERROR: %s\n", error.c_str());
+    return (-1);
+  }
+
+  printf("rows: %zu  rejected: %ld", cols.rows(), stats.rejected);
+  if (stats.rejected)
+    printf(" (first on line %d, %ld with invalid dates)", stats.firstRejectedLine, stats.badDates);
+  printf("\nbuild: %.3f s  (%.2f GB/s of CSV)\n", t1 - t0, size / (t1 - t0 + 1e-9) / 1e9);
+  if (saveTo) {
+    if (!write_column_file(saveTo, cols.view(), error)) {
+      printf("ERROR: %s\n", error.c_str());
+      return (-1);
+    }
+    printf("wrote: %s  (%.3f s)\n", saveTo, seconds() - t1);
+  }
+  print_columns(cols.view());
+  return 0;
+}
+
+// Print a tally the way --quiet, --count and --histogram ask for
+void print_tally( const Tally& tally, bool quiet, bool count )
+{
+  if (quiet && !count && tally.histColumn < 0)
+    printf("tokens: %ld\n", tally.total());
+  if (count)
+    print_counts(tally, stdout);
+  if (tally.histColumn >= 0)
+    print_histogram(tally, stdout);
+}
+
+// Scan several files (directories, globs, names) on a work-stealing pool
+// (ingest.h) and print their merged aggregates, the files that failed and
+// the ingest rate
+int run_files( const std::vector<const char*>& args, const IngestOptions& opt,
+               bool quiet, bool count, const char* saveColumns )
+{
+  std::vector<std::string> files;
+  std::string error;
+  for (size_t i = 0; i < args.size(); i++)
+    if (!expand_inputs(args[i], files, error)) {
+      printf("ERROR: %s\n", error.c_str());
+      return (-1);
+    }
+  printf("INFO: Using %zu files for input\n", files.size());
+
+  IngestResult result;
+  double t0 = seconds();
+  ingest_files(files, opt, result);
+  double t1 = seconds();
+
+  for (size_t i = 0; i < result.failures.size(); i++)
+    printf("ERROR: %s\n", result.failures[i].c_str());
+  if (opt.mode == INGEST_TALLY)
+    print_tally(result.tally, quiet, count);
+  else if (opt.mode == INGEST_QUERY)
+    printf("rows: %ld  matched: %ld\n", result.counts.rows, result.counts.matched);
+  else {
+    printf("rows: %zu  rejected: %ld", result.columns.rows(), result.stats.rejected);
+    if (result.stats.rejected)
+      printf(" (first in %s on line %d, %ld with invalid dates)", result.firstRejectedFile.c_str(),
+             result.stats.firstRejectedLine, result.stats.badDates);
+    printf("\n");
+    if (saveColumns) {
+      if (!write_column_file(saveColumns, result.columns.view(), error)) {
+        printf("ERROR: %s\n", error.c_str());
+        return (-1);
+      }
+      printf("wrote: %s\n", saveColumns);
+    }
+    print_columns(result.columns.view());
+  }
+  if (opt.resync)
+    print_errors(result.errors, NULL, stdout);
+
+  double secs = t1 - t0 + 1e-9;
+  printf("files: %zu", result.files);
+  if (!result.failures.empty()) printf(" (%zu failed)", result.failures.size());
+  printf("  bytes: %zu  time: %.3f s  (%.0f files/s, %.1f MB/s; %d threads, %ld steals)\n",
+         result.bytes, t1 - t0, (result.files + result.failures.size()) / secs,
+         result.bytes / secs / 1e6, opt.threads, result.steals);
+  return result.failures.empty() ? 0 : (-2);
+}
+
+// Map a column file written by --write-columns and summarize it
+int run_column_file( const char* path )
+{
+  double t0 = seconds();
+  ColumnFile file;
+  std::string error;
+  if (!file.open(path, error)) {
+    printf("ERROR: %s\n", error.c_str());
+    return (-1);
+  }
+  printf("rows: %zu\nmap: %.6f s\n", file.view().rows, seconds() - t0);
+  print_columns(file.view());
+  return 0;
+}
+
+// Count the rows of a column file that match `query`, reading only the
+// blocks its zone map does not rule out
+int run_column_query( const char* path, const Query& query )
+{
+  ColumnFile file;
+  std::string error;
+  if (!file.open(path, error)) {
+    printf("ERROR: %s\n", error.c_str());
+    return (-1);
+  }
+  const ColumnsView& cols = file.view();
+  const ColFileZone* zones = file.zones();
+  size_t blocks = file.zoneBlocks();
+  size_t blockRows = zones ? file.zoneRows() : cols.rows;
+  QueryCounts counts = { 0, 0 };
+  size_t skipped = 0, skippedRows = 0;
+
+  double t0 = seconds();
+  if (!zones)
+    query.runColumns(cols, 0, cols.rows, counts);
+  for (size_t b = 0; b < blocks; b++) {
+    size_t first = b * blockRows;
+    size_t last = first + blockRows < cols.rows ? first + blockRows : cols.rows;
+    if (query.mayMatch(zones[b].min, zones[b].max))
+      query.runColumns(cols, first, last, counts);
+    else {
+      counts.rows += last - first;
+      skipped++;
+      skippedRows += last - first;
+    }
+  }
+  double t1 = seconds();
+
+  printf("rows: %ld  matched: %ld\n", counts.rows, counts.matched);
+  if (zones)
+    printf("blocks: %zu of %zu rows  skipped: %zu (%.1f%% of rows)\n", blocks, blockRows,
+           skipped, cols.rows ? 100.0 * skippedRows / cols.rows : 0.0);
+  else
+    printf("blocks: none (no zone map in this file)\n");
+  printf("query: %.6f s\n", t1 - t0);
+  return 0;
+}
+
+
+// The number in "--option=N" (`arg`, whose first `prefix` bytes are the
+// "--option="): a whole number from `least` to `most`. Otherwise prints a
+// usage error and returns false.
+static bool number_option( const char* arg, size_t prefix, long least, long most,
+                           long& value )
+{
+  const char* text = arg + prefix;
+  char* stop;
+  errno = 0;
+  value = strtol(text, &stop, 10);
+  if (stop != text && *stop == '\0' && errno == 0 && value >= least && value <= most)
+    return true;
+  printf("ERROR: %.*sN needs a whole number N >= %ld", (int)prefix, arg, least);
+  if (most < LONG_MAX) printf(" and <= %ld", most);
+  printf(", not '%s'\n", text);
+  return false;
+}
+// Do the analysis (a gzip file, e.g. data.csv.gz, is read as is)
+//   lex [--simd] [--threads=N [--chunk-size=BYTES]]
+//       [--quiet] [--count] [--histogram=COLUMN]
+//       [--records] [--write-columns=OUT | --read-columns]
+//       [--where QUERY] [--resync[=FILE] [--max-errors=N]] [--lenient]
+//       [--dedup[=report]] [--follow[=SECONDS]] [--uring]
+//       [--distinct=COLUMNS|row ...] [--sample=N [--seed=S]] [file...]
+//     --simd              use the SIMD scanning engine instead of flex
+//     --threads=N         SIMD engine on N threads (same output)
+//     --chunk-size=BYTES  bytes per chunk for --threads (default 1 MiB)
+//     --quiet             no per-token lines; print the token total at the end
+//     --count             no per-token lines; print totals per token type
+//     --histogram=COLUMN  no per-token lines; print value counts for one
+//                         column (name, short name like "age", or number)
+//     --records           build typed columns (records.h) and summarize them;
+//                         on N threads with --threads=N
+//     --write-columns=OUT --records, and save the columns to OUT (colfile.h)
+//     --read-columns      the input is a column file: map and summarize it
+//     --where QUERY       print the rows that pass QUERY (query.h), e.g.
+//                         'status=LABORATORY and gender=FEMALE'; with
+//                         --count print how many rows pass; with
+//                         --read-columns --count count them in the column
+//                         file, skipping blocks by date (colfile.h)
+//     --resync[=FILE]     skip lines with unknown tokens instead of stopping
+//                         (resync.h), writing them to FILE; the SIMD engine;
+//                         also with --records and --where
+//     --max-errors=N      --resync, but give up after N bad lines
+//     --lenient           ignore case and blanks in values that the rules
+//                         do not spell (fieldclass.h); the SIMD engine
+//     --dedup[=report]    print each row once, dropping rows that repeat an
+//                         earlier one; =report prints only the repeats;
+//                         with --count print how many (dedup.h)
+//     --follow[=SECONDS]  keep reading lines appended to the file (follow.h)
+//                         until it is idle for SECONDS, removed, or ^C;
+//                         the SIMD engine
+//     --uring             read plain files with io_uring, several reads
+//                         ahead of the scanner (uringsource.h)
+//     --distinct=COLUMNS  estimate the distinct combinations of the columns
+//                         (e.g. case_date,sex), or with "row" the distinct
+//                         rows, in 16 KiB (sketch.h); may be repeated
+//     --sample=N          print a uniform sample of N rows; --seed=S picks
+//                         another one
+// Several files, a directory (its *.csv and *.csv.gz files) or a quoted glob
+// like 'data/*.csv' are scanned together (ingest.h) on --threads=N threads
+// (default: one per core) with --quiet, --count, --histogram, --records,
+// --write-columns or --where with --count, and the totals are merged.
+int main( int argc, char* argv[] )
+{
+  const char* path = NULL;
+  std::vector<const char*> inputs;
+  bool simd = false;
+  bool records = false;
+  bool readColumns = false;
+  const char* saveColumns = NULL;
+  int threads = 0;
+  bool quiet = false;
+  bool count = false;
+  int histColumn = -1;
+  size_t chunkSize = kDefaultChunkSize;
+  const char* where = NULL;
+  Query query;
+  std::string queryError;
+  bool resync = false;
+  const char* quarantine = NULL;
+  long maxErrors = -1;
+  bool lenient = false;
+  bool uring = false;
+  SketchSpec sketch;
+  sketch.sample = 0;
+  sketch.seed = 1;
+  bool dedup = false;
+  bool dedupReport = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--simd") == 0)
+      simd = true;
+    else if (strncmp(argv[i], "--threads=", 10) == 0) {
+      long n;
+      if (!number_option(argv[i], 10, 1, 1024, n))
+        return (-1);
+      threads = (int)n;
+    }
+    else if (strncmp(argv[i], "--chunk-size=", 13) == 0) {
+      long n;
+      if (!number_option(argv[i], 13, 1, LONG_MAX, n))
+        return (-1);
+      chunkSize = n;
+    }
+    else if (strcmp(argv[i], "--quiet") == 0)
+      quiet = true;
+    else if (strcmp(argv[i], "--count") == 0)
+      count = true;
+    else if (strncmp(argv[i], "--histogram=", 12) == 0) {
+      histColumn = find_column(argv[i] + 12);
+      if (histColumn < 0) {
+        printf("ERROR: unknown column %s\n", argv[i] + 12);
+        return (-1);
+      }
+    }
+    else if (strcmp(argv[i], "--records") == 0)
+      records = true;
+    else if (strncmp(argv[i], "--write-columns=", 16) == 0 && argv[i][16])
+      records = true, saveColumns = argv[i] + 16;
+    else if (strcmp(argv[i], "--read-columns") == 0)
+      readColumns = true;
+    else if (strcmp(argv[i], "--resync") == 0)
+      resync = true;
+    else if (strncmp(argv[i], "--resync=", 9) == 0 && argv[i][9])
+      resync = true, quarantine = argv[i] + 9;
+    else if (strncmp(argv[i], "--max-errors=", 13) == 0) {
+      if (!number_option(argv[i], 13, 0, LONG_MAX, maxErrors))
+        return (-1);
+      resync = true;
+    }
+    else if (strcmp(argv[i], "--lenient") == 0)
+      lenient = true;
+    else if (strcmp(argv[i], "--uring") == 0)
+      uring = true;
+    else if (strncmp(argv[i], "--distinct=", 11) == 0) {
+      uint32_t key;
+      if (!parse_sketch_key(argv[i] + 11, key)) {
+        printf("ERROR: --distinct: not \"row\" or a list of columns: %s\n", argv[i] + 11);
+        return (-1);
+      }
+      sketch.keys.push_back(key);
+      sketch.names.push_back(argv[i] + 11);
+    }
+    else if (strncmp(argv[i], "--sample=", 9) == 0) {
+      long n;
+      if (!number_option(argv[i], 9, 1, LONG_MAX, n))
+        return (-1);
+      sketch.sample = n;
+    }
+    else if (strncmp(argv[i], "--seed=", 7) == 0) {
+      const char* text = argv[i] + 7;
+      char* stop;
+      errno = 0;
+      sketch.seed = strtoull(text, &stop, 10);
+      if (!isdigit((unsigned char)*text) || *stop || errno) {
+        printf("ERROR: --seed=S needs a whole number S >= 0, not '%s'\n", text);
+        return (-1);
+      }
+    }
+    else if (strcmp(argv[i], "--dedup") == 0)
+      dedup = true;
+    else if (strcmp(argv[i], "--dedup=report") == 0)
+      dedup = dedupReport = true;
+    else if (strcmp(argv[i], "--follow") == 0)
+      follow = true;
+    else if (strncmp(argv[i], "--follow=", 9) == 0) {
+      char* stop;
+      followIdle = strtod(argv[i] + 9, &stop);
+      if (stop == argv[i] + 9 || *stop || !(followIdle >= 0)) {
+        printf("ERROR: --follow=SECONDS needs a number of seconds >= 0, not '%s'\n", argv[i] + 9);
+        return (-1);
+      }
+      follow = true;
+    }
+    else if (strncmp(argv[i], "--where=", 8) == 0 || (strcmp(argv[i], "--where") == 0 && i + 1 < argc))
+      where = argv[i][7] ? argv[i] + 8 : argv[++i];
+    else if (strncmp(argv[i], "--", 2) == 0) {
+      printf("ERROR: unknown option %s\n", argv[i]);
+      printf("usage: %s [--simd] [--threads=N [--chunk-size=BYTES]]\n"
+             "       [--quiet] [--count] [--histogram=COLUMN]\n"
+             "       [--records] [--write-columns=OUT | --read-columns]\n"
+             "       [--where QUERY] [--resync[=FILE] [--max-errors=N]] [--lenient]\n"
+             "       [--dedup[=report]] [--follow[=SECONDS]] [--uring]\n"
+             "       [--distinct=COLUMNS|row ...] [--sample=N [--seed=S]] [file...]\n",
+             argv[0]);
+      return (-1);
+    }
+    else {
+      if (!path) path = argv[i];
+      inputs.push_back(argv[i]);
+    }
+  }
+
+  // --records and --write-columns keep every row; they would drop the query
+  if (where && (quiet || histColumn >= 0 || records || (readColumns && !count))) {
+    printf("ERROR: --where works with --count only\n");
+    return (-1);
+  }
+  // --records prints its own summary, not a token count or histogram
+  if (records && (quiet || count || histColumn >= 0)) {
+    printf("ERROR: --records and --write-columns do not work with --quiet, --count\n"
+           "       or --histogram\n");
+    return (-1);
+  }
+  // a column file holds only valid records, so there is nothing to resync
+  if (resync && readColumns) {
+    printf("ERROR: --resync reads CSV input, not --read-columns\n");
+    return (-1);
+  }
+  // before the query: its values are scanned too
+  fastscan_set_lenient(lenient);
+  source_set_uring(uring);
+  if (uring && !uring_available())
+    printf("INFO: io_uring is not available here; --uring reads with pread\n");
+  if (where && !query.compile(where, queryError)) {
+    printf("ERROR: --where: %s\n", queryError.c_str());
+    return (-1);
+  }
+
+  bool sketching = !sketch.keys.empty() || sketch.sample;
+  if (sketching && (where || records || readColumns || quiet || count || histColumn >= 0 ||
+                    resync || dedup)) {
+    printf("ERROR: --distinct and --sample do not work with other modes\n");
+    return (-1);
+  }
+  if (sketching && (inputs.size() > 1 || (path && is_multi_input(path)))) {
+    printf("ERROR: --distinct and --sample take one input file\n");
+    return (-1);
+  }
+  if (dedup && (where || records || readColumns || quiet || histColumn >= 0 || resync)) {
+    printf("ERROR: --dedup works with --count only\n");
+    return (-1);
+  }
+  if (dedup && (inputs.size() > 1 || (path && is_multi_input(path))) && !follow) {
+    std::vector<std::string> files;
+    std::string error;
+    for (size_t i = 0; i < inputs.size(); i++)
+      if (!expand_inputs(inputs[i], files, error)) {
+        printf("ERROR: %s\n", error.c_str());
+        return (-1);
+      }
+    return run_dedup(files, dedupReport, threads > 0 ? threads : 1, chunkSize, count);
+  }
+  if (follow && (inputs.size() > 1 || (path && is_multi_input(path)) || records || readColumns)) {
+    printf("ERROR: --follow takes one file and does not work with --records\n");
+    return (-1);
+  }
+  if (inputs.size() > 1 || (path && is_multi_input(path))) {
+    IngestOptions opt;
+    opt.mode = records ? INGEST_RECORDS : where ? INGEST_QUERY : INGEST_TALLY;
+    opt.threads = threads > 0 ? threads : (int)std::thread::hardware_concurrency();
+    opt.chunkSize = chunkSize;
+    opt.histColumn = histColumn;
+    opt.query = &query;
+    opt.resync = resync;
+    if (readColumns || (where && !count) || (!where && !records && !quiet && !count && histColumn < 0)) {
+      printf("ERROR: several input files need --quiet, --count, --histogram, --records\n"
+             "       or --where with --count\n");
+      return (-1);
+    }
+    if (quarantine || maxErrors >= 0) {
+      printf("ERROR: --resync=FILE and --max-errors take one input file\n");
+      return (-1);
+    }
+    return run_files(inputs, opt, quiet, count, saveColumns);
+  }
+
+  // Set the input stream
+  if (path) {
+    printf("INFO: Using the %s file for input\n", path);
+  }
+  else {
+    printf("INFO: Using the sample.csv file for input\n");
+    path = "sample.csv";
+  }
+
+  if (follow) {
+    std::string error;
+    if (!follow_check(path, error)) {
+      printf("ERROR: --follow: %s\n", error.c_str());
+      return (-1);
+    }
+    follow_stop_on_signals();
+  }
+
+  if (readColumns && where)
+    return run_column_query(path, query);
+  if (readColumns)
+    return run_column_file(path);
+  if (sketching)
+    return run_sketch(path, sketch, threads > 0 ? threads : 1, chunkSize);
+  if (dedup)
+    return run_dedup(std::vector<std::string>(1, path), dedupReport,
+                     threads > 0 ? threads : 1, chunkSize, count);
+  ErrorLog errors;
+  if (resync) {
+    errors.budget = maxErrors;
+    if (quarantine && !(errors.quarantine = fopen(quarantine, "w"))) {
+      printf("ERROR: cannot write %s\n", quarantine);
+      return (-1);
+    }
+  }
+  if (records || where) {
+    int status = records
+      ? run_records(path, saveColumns, threads, chunkSize, resync ? &errors : NULL)
+      : run_query(path, query, threads > 0 ? threads : 1, chunkSize, count,
+                  resync ? &errors : NULL);
+    if (errors.quarantine)
+      fclose(errors.quarantine);
+    if (status == 0 && resync)
+      print_errors(errors, quarantine, stdout);
+    return status;
+  }
+  Tally tally(histColumn);
+  Tally* counting = (quiet || count || histColumn >= 0) ? &tally : NULL;
+  int status;
+  if (threads > 0)
+    status = run_parallel(path, threads, chunkSize, counting, resync ? &errors : NULL);
+  else if (simd || resync || lenient || follow)
+    status = run_simd(path, counting, resync ? &errors : NULL);
+  else
+    status = run_flex(path, counting);
+  if (errors.quarantine)
+    fclose(errors.quarantine);
+  if (status == 0 && resync && !counting)
+    print_errors(errors, quarantine, stdout);
+  if (status != 0 || !counting)
+    return status;
+
+  print_tally(tally, quiet, count);
+  if (resync)
+    print_errors(errors, quarantine, stdout);
+  return 0;
+}
@@ -0,0 +1,485 @@
+//*****************************************************************************
+// purpose: SIMD scanning engine for Lab 1 - see fastscan.h
+// version: Fall 2024
+//*****************************************************************************
+#include "fastscan.h"
+#include "fieldclass.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FASTSCAN_X86 1
+#endif
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// The rules of exp-rules.l, in the same order (keep the two in sync).
+// [Xx] marks a position where either case matches; DATE is matched by code.
+//-----------------------------------------------------------------------------
+struct Rule
+{
+  const char *spec;
+  int         code;
+};
+
+const Rule kRules[] = {
+  { ",",                                     SEPARATOR },
+  { "[Yy]es",                                YES },
+  { "[Nn]o",                                 NO },
+  { 0,                                       DATE },
+  { "[Uu]nknown",                            UNKNOWN_VALUE },
+  { "[Mm]issing",                            MISSING },
+  { "[Ll]aboratory-confirmed [Cc]ase",       LABORATORY },
+  { "[Pp]robable [Cc]ase",                   PROBABLE },
+  { "[Mm]ale",                               MALE },
+  { "[Ff]emale",                             FEMALE },
+  { "[Oo]ther",                              OTHER },
+  { "0 - 9 [Yy]ears",                        AGE_0X },
+  { "10 - 19 [Yy]ears",                      AGE_1X },
+  { "20 - 39 [Yy]ears",                      AGE_2X },
+  { "40 - 49 [Yy]ears",                      AGE_4X },
+  { "50 - 59 [Yy]ears",                      AGE_5X },
+  { "60 - 69 [Yy]ears",                      AGE_6X },
+  { "70 - 79 [Yy]ears",                      AGE_7X },
+  { "80+ [Yy]ears",                          AGE_8X },
+  { "\"[Hh]ispanic/[Ll]atino\"",             HISPANIC },
+  { "\"[Aa]merican [Ii]ndian / [Aa]laska [Nn]ative, [Nn]on-Hispanic\"",
+                                             NATIVE_AMERICAN },
+  { "\"[Aa]sian, [Nn]on-Hispanic\"",         ASIAN },
+  { "\"[Bb]lack, [Nn]on-Hispanic\"",         BLACK },
+  { "\"[Nn]ative [Hh]awaiian / [Oo]ther [Pp]acific [Ii]slander, [Nn]on-Hispanic\"",
+                                             PACIFIC_ISLANDER },
+  { "\"[Ww]hite, [Nn]on-Hispanic\"",         WHITE },
+  { "\"[Mm]ultiple/[Oo]ther, [Nn]on-Hispanic\"",
+                                             MULTIPLE_OTHER },
+};
+
+const int kRuleCount = sizeof(kRules) / sizeof(kRules[0]);
+const int kDateLength = 10;
+
+// A rule compiled from its spec: text holds the lower-case letter at
+// positions that accept either case (bit i of fold set; caseBit has 0x20
+// there so a field matches when (byte | caseBit) == text, 8 bytes at a time)
+struct Pattern
+{
+  char     text[64];
+  char     caseBit[64];
+  uint64_t fold;
+  int      length;
+  int      code;
+  int      order;   // rule index; earlier rules win ties
+};
+
+} // namespace
+
+struct ScanTables
+{
+  Pattern patterns[kRuleCount];
+  int     count;
+  // patterns that can start with each byte, in rule order
+  signed char byFirst[256][8];
+  // patterns by first byte and length (the fast path's lookup), in rule
+  // order; sameShape chains patterns with the same first byte and length
+  signed char byShape[256][64];
+  signed char sameShape[kRuleCount];
+  bool    fastPathSafe;  // no rule can match a prefix of another
+};
+
+namespace
+{
+
+inline bool pattern_matches(const Pattern &pt, const char *s)
+{
+  int i = 0;
+  for (; i + 8 <= pt.length; i += 8)
+  {
+    uint64_t in, want, fold;
+    memcpy(&in, s + i, 8);
+    memcpy(&want, pt.text + i, 8);
+    memcpy(&fold, pt.caseBit + i, 8);
+    if ((in | fold) != want) return false;
+  }
+  for (; i < pt.length; ++i)
+    if ((s[i] | pt.caseBit[i]) != pt.text[i]) return false;
+  return true;
+}
+
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+inline bool is_date(const char *s)
+{
+  return is_digit(s[0]) && is_digit(s[1]) && is_digit(s[2]) && is_digit(s[3]) &&
+         s[4] == '/' && is_digit(s[5]) && is_digit(s[6]) &&
+         s[7] == '/' && is_digit(s[8]) && is_digit(s[9]);
+}
+
+inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Could some input match both position i of a and position i of b?
+// (Over-approximates: any case-insensitive equality counts.)
+bool chars_overlap(const Pattern &a, int i, const Pattern &b, int j)
+{
+  char x = a.text[i], y = b.text[j];
+  if (x == y) return true;
+  bool fx = (a.fold >> i) & 1, fy = (b.fold >> j) & 1;
+  return (fx || fy) && (x | 0x20) == (y | 0x20);
+}
+
+bool date_overlaps(const Pattern &pt)
+{
+  for (int i = 0; i < pt.length && i < kDateLength; ++i)
+  {
+    char c = pt.text[i];
+    bool slash = (i == 4 || i == 7);
+    if (slash ? c != '/' : !is_digit(c)) return false;
+  }
+  return true;
+}
+
+ScanTables build_tables()
+{
+  ScanTables t;
+  memset(&t, 0, sizeof t);
+  memset(t.byFirst, -1, sizeof t.byFirst);
+  memset(t.byShape, -1, sizeof t.byShape);
+  memset(t.sameShape, -1, sizeof t.sameShape);
+  t.count = 0;
+  for (int r = 0; r < kRuleCount; ++r)
+  {
+    if (!kRules[r].spec) continue;
+    Pattern &pt = t.patterns[t.count];
+    pt.code = kRules[r].code;
+    pt.order = r;
+    for (const char *s = kRules[r].spec; *s; ++s)
+    {
+      if (s[0] == '[' && s[3] == ']')
+      {
+        pt.fold |= 1ull << pt.length;
+        pt.caseBit[pt.length] = 0x20;
+        pt.text[pt.length++] = s[2];   // "[Xx]" -> 'x'
+        s += 3;
+      }
+      else
+        pt.text[pt.length++] = *s;
+    }
+    unsigned char first = pt.text[0];
+    int idx = t.count++;
+    for (int k = 0; k < 2; ++k)
+    {
+      unsigned char c = k == 0 ? first : (unsigned char)(first & ~0x20);
+      if (k == 1 && !(pt.fold & 1)) break;
+      signed char *slot = t.byFirst[c];
+      while (*slot >= 0) ++slot;
+      *slot = (signed char)idx;
+      slot = &t.byShape[c][pt.length];
+      while (*slot >= 0) slot = &t.sameShape[(int)*slot];
+      *slot = (signed char)idx;
+    }
+  }
+
+  t.fastPathSafe = true;
+  for (int a = 0; a < t.count; ++a)
+  {
+    if (date_overlaps(t.patterns[a]))
+      t.fastPathSafe = false;
+    for (int b = 0; b < t.count; ++b)
+    {
+      const Pattern &pa = t.patterns[a], &pb = t.patterns[b];
+      if (a == b || pa.length >= pb.length) continue;
+      int i = 0;
+      while (i < pa.length && chars_overlap(pa, i, pb, i)) ++i;
+      if (i == pa.length) t.fastPathSafe = false;
+    }
+  }
+  return t;
+}
+
+const ScanTables &tables()
+{
+  static const ScanTables t = build_tables();
+  return t;
+}
+
+//-----------------------------------------------------------------------------
+// Block masks: bit i set when block[i] is one of the bytes of interest
+//-----------------------------------------------------------------------------
+typedef void (*MaskFn)(const char *block, uint64_t &fieldEnd, uint64_t &quoteEnd);
+
+void masks_scalar(const char *block, uint64_t &fieldEnd, uint64_t &quoteEnd)
+{
+  uint64_t f = 0, q = 0;
+  for (int i = 0; i < 64; ++i)
+  {
+    char c = block[i];
+    uint64_t bit = 1ull << i;
+    if (c == '"' || c == '\n') { f |= bit; q |= bit; }
+    else if (c == ',') f |= bit;
+  }
+  fieldEnd = f;
+  quoteEnd = q;
+}
+
+#ifdef FASTSCAN_X86
+void masks_sse2(const char *block, uint64_t &fieldEnd, uint64_t &quoteEnd)
+{
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i nl    = _mm_set1_epi8('\n');
+  const __m128i quote = _mm_set1_epi8('"');
+  uint64_t f = 0, q = 0;
+  for (int i = 0; i < 4; ++i)
+  {
+    __m128i v  = _mm_loadu_si128((const __m128i *)(block + 16 * i));
+    __m128i qn = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, nl));
+    __m128i fe = _mm_or_si128(qn, _mm_cmpeq_epi8(v, comma));
+    f |= (uint64_t)(uint16_t)_mm_movemask_epi8(fe) << (16 * i);
+    q |= (uint64_t)(uint16_t)_mm_movemask_epi8(qn) << (16 * i);
+  }
+  fieldEnd = f;
+  quoteEnd = q;
+}
+
+__attribute__((target("avx2")))
+void masks_avx2(const char *block, uint64_t &fieldEnd, uint64_t &quoteEnd)
+{
+  const __m256i comma = _mm256_set1_epi8(',');
+  const __m256i nl    = _mm256_set1_epi8('\n');
+  const __m256i quote = _mm256_set1_epi8('"');
+  uint64_t f = 0, q = 0;
+  for (int i = 0; i < 2; ++i)
+  {
+    __m256i v  = _mm256_loadu_si256((const __m256i *)(block + 32 * i));
+    __m256i qn = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, nl));
+    __m256i fe = _mm256_or_si256(qn, _mm256_cmpeq_epi8(v, comma));
+    f |= (uint64_t)(uint32_t)_mm256_movemask_epi8(fe) << (32 * i);
+    q |= (uint64_t)(uint32_t)_mm256_movemask_epi8(qn) << (32 * i);
+  }
+  fieldEnd = f;
+  quoteEnd = q;
+}
+#endif
+
+struct Isa
+{
+  const char *name;
+  MaskFn      fn;
+};
+
+Isa pick_isa()
+{
+  const char *want = getenv("FASTSCAN_ISA");
+  Isa scalar = { "scalar", masks_scalar };
+  if (want && !strcmp(want, "scalar")) return scalar;
+#ifdef FASTSCAN_X86
+  Isa sse2 = { "sse2", masks_sse2 };
+  if (want && !strcmp(want, "sse2")) return sse2;
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+  {
+    Isa avx2 = { "avx2", masks_avx2 };
+    return avx2;
+  }
+  return sse2;
+#else
+  return scalar;
+#endif
+}
+
+const Isa &isa()
+{
+  static const Isa i = pick_isa();
+  return i;
+}
+
+} // namespace
+
+const char *fastscan_isa()
+{
+  return isa().name;
+}
+
+static bool gLenient = false;
+
+void fastscan_set_lenient(bool on)
+{
+  gLenient = on;
+}
+
+//-----------------------------------------------------------------------------
+// FastScanner
+//-----------------------------------------------------------------------------
+FastScanner::FastScanner(const char *begin, const char *end, int firstLine)
+  : begin_(begin), end_(end), p_(begin), line_(firstLine),
+    slowUntil_(begin), lenient_(gLenient), tables_(&tables()), masks_(isa().fn),
+    cachedBlock_((size_t)-1)
+{
+}
+
+const FastScanner::Masks &FastScanner::masksFor(size_t block)
+{
+  if (block != cachedBlock_)
+  {
+    const char *at = begin_ + block * 64;
+    if (end_ - at >= 64)
+      masks_(at, cached_.fieldEnd, cached_.quoteEnd);
+    else
+    {
+      // last partial block: pad with NULs, which are not in any mask
+      char tail[64] = { 0 };
+      memcpy(tail, at, end_ - at);
+      masks_(tail, cached_.fieldEnd, cached_.quoteEnd);
+    }
+    cachedBlock_ = block;
+  }
+  return cached_;
+}
+
+const char *FastScanner::findFieldEnd(const char *from)
+{
+  size_t off = from - begin_, size = end_ - begin_;
+  while (off < size)
+  {
+    uint64_t m = masksFor(off >> 6).fieldEnd >> (off & 63);
+    if (m) return begin_ + off + __builtin_ctzll(m);
+    off = (off | 63) + 1;
+  }
+  return end_;
+}
+
+const char *FastScanner::findQuoteEnd(const char *from)
+{
+  size_t off = from - begin_, size = end_ - begin_;
+  while (off < size)
+  {
+    uint64_t m = masksFor(off >> 6).quoteEnd >> (off & 63);
+    if (m) return begin_ + off + __builtin_ctzll(m);
+    off = (off | 63) + 1;
+  }
+  return end_;
+}
+
+// Token code of a whole field that spells exactly one rule, else 0
+int FastScanner::matchField(const char *field, size_t len) const
+{
+  const ScanTables &t = *tables_;
+  if (len >= 64 || !t.fastPathSafe) return 0;
+  if (len == (size_t)kDateLength && is_date(field)) return DATE;
+  for (int c = t.byShape[(unsigned char)field[0]][len]; c >= 0; c = t.sameShape[c])
+    if (pattern_matches(t.patterns[c], field)) return t.patterns[c].code;
+  return 0;
+}
+
+// flex semantics at one position: longest match, then earliest rule,
+// then '.' (one byte) as UNKNOWN_TOKEN
+int FastScanner::matchLongest(const char *at, int &len) const
+{
+  const ScanTables &t = *tables_;
+  ptrdiff_t avail = end_ - at;
+  int best = 0, code = UNKNOWN_TOKEN, order = kRuleCount;
+  if (avail >= kDateLength && is_date(at))
+  {
+    best = kDateLength;
+    code = DATE;
+    order = 3;
+  }
+  for (const signed char *c = t.byFirst[(unsigned char)*at]; *c >= 0; ++c)
+  {
+    const Pattern &pt = t.patterns[*c];
+    if (pt.length > avail || !pattern_matches(pt, at)) continue;
+    if (pt.length > best || (pt.length == best && pt.order < order))
+    {
+      best = pt.length;
+      code = pt.code;
+      order = pt.order;
+    }
+  }
+  len = best ? best : 1;
+  return best ? code : UNKNOWN_TOKEN;
+}
+
+int FastScanner::next(ScanToken &tok)
+{
+  for (;;)
+  {
+    if (p_ >= end_)
+    {
+      tok.code = EOF_TOKEN;
+      tok.text = end_;
+      tok.length = 0;
+      tok.line = line_;
+      return EOF_TOKEN;
+    }
+
+    char c = *p_;
+    if (is_blank(c))
+    {
+      do ++p_; while (p_ < end_ && is_blank(*p_));
+      continue;
+    }
+    if (c == '\n')
+    {
+      ++line_;
+      ++p_;
+      continue;
+    }
+
+    tok.text = p_;
+    tok.line = line_;
+    if (c == ',')
+    {
+      tok.code = SEPARATOR;
+      tok.length = 1;
+      ++p_;
+      return SEPARATOR;
+    }
+
+    // Fast path: the whole field (up to ',' '\n' or a quote, trailing
+    // blanks trimmed; or "..." for a quoted field) is one rule
+    if (p_ >= slowUntil_)
+    {
+      const char *e;
+      if (c == '"')
+      {
+        const char *q = findQuoteEnd(p_ + 1);
+        e = (q < end_ && *q == '"') ? q + 1 : q;
+      }
+      else
+      {
+        e = findFieldEnd(p_ + 1);
+        while (is_blank(e[-1])) --e;
+      }
+      int code = matchField(p_, e - p_);
+      if (!code && lenient_) code = classify_field(p_, e - p_);
+      if (code)
+      {
+        tok.code = code;
+        tok.length = (int)(e - p_);
+        p_ = e;
+        return code;
+      }
+      // not a single rule: scan this field with the slow path only
+      slowUntil_ = e;
+    }
+
+    int len;
+    tok.code = matchLongest(p_, len);
+    tok.length = len;
+    p_ += len;
+    return tok.code;
+  }
+}
+
+void FastScanner::skipLine()
+{
+  const char *nl = (const char *)memchr(p_, '\n', end_ - p_);
+  if (!nl)
+  {
+    p_ = end_;
+    return;
+  }
+  p_ = nl + 1;
+  ++line_;
+}
@@ -0,0 +1,98 @@
+//*****************************************************************************
+// purpose: SIMD scanning engine for Lab 1 (alternative to the flex scanner)
+// version: Fall 2024
+//
+// FastScanner tokenizes a buffer in memory and returns the same tokens,
+// lexemes and line numbers as the flex rules in exp-rules.l.
+//
+// How it works:
+//   * Block masks.  For each 64-byte block the scanner builds bitmasks of
+//     the bytes that can end a field (',' '\n' '"') and of the bytes that
+//     can end a quoted field ('"' '\n'). SSE2 is the baseline; AVX2 is
+//     used when the CPU has it. Finding the end of a field is then a
+//     count-trailing-zeros.
+//   * Field fast path.  A field with trailing blanks trimmed that spells
+//     one rule exactly is returned as that rule. No rule is a prefix of
+//     another, so the rule flex would pick here (longest match) is this one.
+//   * Slow path.  Anything else (unknown bytes, several tokens inside one
+//     field, "2020//02/01") falls back to trying every rule at the current
+//     position, longest match first, then rule order, then '.' as
+//     UNKNOWN_TOKEN. This is exactly the flex semantics.
+//   * Lenient fields.  After fastscan_set_lenient(true) a field that is no
+//     rule as a whole is looked up in fieldclass.h (case and blanks do not
+//     matter) before the slow path is tried.
+//
+// No token spans a '\n', so any newline is a safe place to start a scanner
+// (see the firstLine argument).
+//*****************************************************************************
+#ifndef FASTSCAN_H
+#define FASTSCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "lexer.h"
+
+// One token: the lexeme points into the scanned buffer (not NUL-terminated)
+struct ScanToken
+{
+  int         code;    // token code from lexer.h
+  const char *text;    // first byte of the lexeme
+  int         length;  // lexeme length in bytes
+  int         line;    // line number, as line_number in the flex driver
+};
+
+struct ScanTables;
+
+class FastScanner
+{
+public:
+  // Scan [begin, end); the first byte is on line firstLine
+  FastScanner(const char *begin, const char *end, int firstLine = 1);
+
+  // Next token; returns tok.code. Returns EOF_TOKEN at the end of the buffer
+  // (and keeps returning it).
+  int next(ScanToken &tok);
+
+  // Skip the rest of the current line without tokenizing it; the next
+  // token is the first one of the following line
+  void skipLine();
+
+  int         line() const { return line_; }
+  const char *position() const { return p_; }
+
+private:
+  struct Masks
+  {
+    uint64_t fieldEnd;  // ',' '\n' '"'
+    uint64_t quoteEnd;  // '"' '\n'
+  };
+
+  const char *findFieldEnd(const char *from);
+  const char *findQuoteEnd(const char *from);
+  const Masks &masksFor(size_t block);
+
+  int matchField(const char *field, size_t len) const;
+  int matchLongest(const char *at, int &len) const;
+
+  const char *begin_;
+  const char *end_;
+  const char *p_;
+  int         line_;
+  const char *slowUntil_;  // end of a field the fast path could not match
+  bool        lenient_;    // fastscan_set_lenient() when constructed
+  const ScanTables *tables_;
+  void (*masks_)(const char *block, uint64_t &fieldEnd, uint64_t &quoteEnd);
+
+  size_t cachedBlock_;
+  Masks  cached_;
+};
+
+// Name of the block-mask implementation in use ("avx2", "sse2" or "scalar").
+// FASTSCAN_ISA=scalar|sse2|avx2 in the environment forces one (for benchmarks).
+const char *fastscan_isa();
+
+// --lenient: classify whole fields with classify_field() (fieldclass.h)
+// when no rule matches them. Scanners made afterwards use the setting.
+void fastscan_set_lenient(bool on);
+
+#endif
@@ -0,0 +1,141 @@
+//*****************************************************************************
+// purpose: lenient field classifier for Lab 1 (lex --lenient)
+// version: Fall 2024
+//
+// The rules in exp-rules.l spell every value with case-variant classes
+// ([Ll]aboratory-confirmed\ [Cc]ase): only the first letter of a word may
+// change case and the blanks inside a value must be exactly as written, so
+// "LABORATORY-CONFIRMED CASE", "10-19 years" or "White,  Non-Hispanic" are
+// unknown tokens. With --lenient a field that no rule matches as a whole
+// is looked up once more by classify_field(): its blanks are dropped, its
+// letters folded to lower case, and the key is found in kFieldValues
+// through a perfect hash built at compile time (as in Lab 3's keywords.h:
+// build_field_table() searches for a seed that gives every value a slot of
+// its own). Folding and hashing is one pass over the field, followed by at
+// most one compare. A new category is one more line in kFieldValues.
+//
+// Dates are not categories; they still need the DATE rule.
+//*****************************************************************************
+#ifndef FIELDCLASS_H
+#define FIELDCLASS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "lexer.h"
+
+struct FieldValue
+{
+  const char* text;   // any spelling; case and blanks do not matter
+  int         code;
+};
+
+constexpr FieldValue kFieldValues[] = {
+  { "Yes",                                                  YES },
+  { "No",                                                   NO },
+  { "Unknown",                                              UNKNOWN_VALUE },
+  { "Missing",                                              MISSING },
+  { "Laboratory-confirmed case",                            LABORATORY },
+  { "Probable case",                                        PROBABLE },
+  { "Male",                                                 MALE },
+  { "Female",                                               FEMALE },
+  { "Other",                                                OTHER },
+  { "0 - 9 Years",                                          AGE_0X },
+  { "10 - 19 Years",                                        AGE_1X },
+  { "20 - 39 Years",                                        AGE_2X },
+  { "40 - 49 Years",                                        AGE_4X },
+  { "50 - 59 Years",                                        AGE_5X },
+  { "60 - 69 Years",                                        AGE_6X },
+  { "70 - 79 Years",                                        AGE_7X },
+  { "80+ Years",                                            AGE_8X },
+  { "\"Hispanic/Latino\"",                                  HISPANIC },
+  { "\"American Indian / Alaska Native, Non-Hispanic\"",    NATIVE_AMERICAN },
+  { "\"Asian, Non-Hispanic\"",                              ASIAN },
+  { "\"Black, Non-Hispanic\"",                              BLACK },
+  { "\"Native Hawaiian / Other Pacific Islander, Non-Hispanic\"",
+                                                            PACIFIC_ISLANDER },
+  { "\"White, Non-Hispanic\"",                              WHITE },
+  { "\"Multiple/Other, Non-Hispanic\"",                     MULTIPLE_OTHER },
+};
+
+constexpr int    kFieldValueCount = sizeof(kFieldValues) / sizeof(kFieldValues[0]);
+constexpr int    kFieldKeyMax = 64;    // longer folded fields are no value
+constexpr size_t kFieldSlots = 128;    // power of two, >= 2x kFieldValueCount
+
+//-----------------------------------------------------------------------------
+// Folding and hashing (the same at compile time and at run time)
+//-----------------------------------------------------------------------------
+constexpr bool field_drops( char c ) { return c == ' ' || c == '\t' || c == '\r'; }
+constexpr char field_fold( char c ) { return c >= 'A' && c <= 'Z' ? (char)(c + 32) : c; }
+
+constexpr uint32_t field_hash_step( uint32_t h, char c )
+{
+  return (h ^ (unsigned char)c) * 16777619u;   // FNV-1a
+}
+constexpr uint32_t field_hash_end( uint32_t h ) { return h ^ (h >> 15); }
+
+struct FieldKey
+{
+  char text[kFieldKeyMax];
+  int  length;
+};
+
+struct FieldTable
+{
+  uint32_t    seed;
+  signed char slot[kFieldSlots];        // index into kFieldValues, or -1
+  FieldKey    keys[kFieldValueCount];   // folded kFieldValues[i].text
+};
+
+constexpr FieldTable build_field_table()
+{
+  FieldTable t = {};
+  for (int i = 0; i < kFieldValueCount; i++) {
+    FieldKey& k = t.keys[i];
+    k.length = 0;
+    for (const char* s = kFieldValues[i].text; *s; s++)
+      if (!field_drops(*s)) k.text[k.length++] = field_fold(*s);
+  }
+  for (uint32_t seed = 1; seed < 100000; seed++) {
+    t.seed = seed;
+    for (size_t s = 0; s < kFieldSlots; s++) t.slot[s] = -1;
+    bool ok = true;
+    for (int i = 0; i < kFieldValueCount && ok; i++) {
+      uint32_t h = seed;
+      for (int j = 0; j < t.keys[i].length; j++) h = field_hash_step(h, t.keys[i].text[j]);
+      size_t at = field_hash_end(h) & (kFieldSlots - 1);
+      ok = t.slot[at] < 0;
+      t.slot[at] = (signed char)i;
+    }
+    if (ok) return t;
+  }
+  t.seed = 0;   // two values fold to the same key
+  return t;
+}
+
+constexpr FieldTable kFieldTable = build_field_table();
+static_assert(kFieldTable.seed != 0, "kFieldValues: two values fold to the same key");
+static_assert(2 * kFieldValueCount <= (int)kFieldSlots, "raise kFieldSlots");
+
+// Token code of the field [field, field + len) with case and blanks
+// ignored; 0 if it is none of kFieldValues
+inline int classify_field( const char* field, size_t len )
+{
+  char key[kFieldKeyMax];
+  int n = 0;
+  uint32_t h = kFieldTable.seed;
+  for (size_t i = 0; i < len; i++) {
+    char c = field[i];
+    if (field_drops(c)) continue;
+    if (n == kFieldKeyMax) return 0;
+    c = field_fold(c);
+    key[n++] = c;
+    h = field_hash_step(h, c);
+  }
+  int i = kFieldTable.slot[field_hash_end(h) & (kFieldSlots - 1)];
+  if (i < 0 || kFieldTable.keys[i].length != n || memcmp(kFieldTable.keys[i].text, key, n) != 0)
+    return 0;
+  return kFieldValues[i].code;
+}
+
+#endif
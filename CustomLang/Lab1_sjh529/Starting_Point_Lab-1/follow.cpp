@@ -0,0 +1,170 @@
+//*****************************************************************************
+// purpose: follow a growing CSV file for Lab 1 - see follow.h
+// version: Fall 2024
+//*****************************************************************************
+#include "follow.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+static volatile sig_atomic_t gStop = 0;
+
+static void on_stop( int )
+{
+  gStop = 1;
+}
+
+void follow_stop_on_signals()
+{
+  struct sigaction sa;
+  memset(&sa, 0, sizeof sa);
+  sa.sa_handler = on_stop;   // no SA_RESTART: poll() returns at once
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+}
+
+bool follow_check( const char* path, std::string& error )
+{
+  struct stat st;
+  if (stat(path, &st) != 0) {
+    error = "input file not found";
+    return false;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    error = std::string(path) + " is not a regular file";
+    return false;
+  }
+  unsigned char magic[2] = { 0, 0 };
+  int fd = open(path, O_RDONLY);
+  bool gzip = fd >= 0 && pread(fd, magic, 2, 0) == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+  if (fd >= 0) close(fd);
+  if (gzip) {
+    error = "a gzip file cannot be followed";
+    return false;
+  }
+  return true;
+}
+
+static double now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+FollowSource::FollowSource()
+  : fd_(-1), inotify_(-1), idle_(-1), lastGrowth_(0), offset_(0), have_(0),
+    handed_(0), stopping_(false), done_(false), caughtUp_(false)
+{
+}
+
+FollowSource::~FollowSource()
+{
+  if (inotify_ >= 0) close(inotify_);
+  if (fd_ >= 0) close(fd_);
+}
+
+bool FollowSource::open( const char* path, double idleSeconds )
+{
+  fd_ = ::open(path, O_RDONLY);
+  if (fd_ < 0) return false;
+  inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_ >= 0 &&
+      inotify_add_watch(inotify_, path, IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF) < 0) {
+    close(inotify_);
+    inotify_ = -1;
+  }
+  buf_.resize(kReadSize);
+  idle_ = idleSeconds;
+  lastGrowth_ = now();
+  return true;
+}
+
+bool FollowSource::next( const char*& begin, const char*& end )
+{
+  // forget the lines the scanner has had
+  memmove(buf_.data(), buf_.data() + handed_, have_ - handed_);
+  have_ -= handed_;
+  handed_ = 0;
+  if (done_) return false;
+
+  for (;;) {
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+      error_ = std::string("follow: ") + strerror(errno);
+      done_ = true;
+      return false;
+    }
+    off_t readAt = offset_ + (off_t)have_;   // file offset of the next byte to read
+    if (st.st_size < readAt) {
+      error_ = "follow: the file was truncated";
+      done_ = true;
+      return false;
+    }
+    if (st.st_size > readAt) {
+      if (have_ == buf_.size()) buf_.resize(buf_.size() * 2);   // a long line
+      ssize_t n = pread(fd_, buf_.data() + have_, buf_.size() - have_, readAt);
+      if (n < 0) {
+        error_ = std::string("follow: ") + strerror(errno);
+        done_ = true;
+        return false;
+      }
+      have_ += n;
+      lastGrowth_ = now();
+    }
+    caughtUp_ = offset_ + (off_t)have_ >= st.st_size;
+
+    const char* nl = (const char*)memrchr(buf_.data(), '\n', have_);
+    if (nl || (stopping_ && caughtUp_)) {
+      if (stopping_ && caughtUp_) {
+        done_ = true;                           // the rest, newline or not
+        if (!have_) return false;
+        handed_ = have_;
+      }
+      else
+        handed_ = nl + 1 - buf_.data();
+      begin = buf_.data();
+      end = begin + handed_;
+      offset_ += handed_;
+      return true;
+    }
+    if (!caughtUp_) continue;
+    if (!wait()) stopping_ = true;
+  }
+}
+
+bool FollowSource::wait()
+{
+  struct stat st;
+  if (gStop || fstat(fd_, &st) != 0 || st.st_nlink == 0) return false;   // deleted
+  double left = 0.2;
+  if (idle_ >= 0) {
+    double idle = idle_ - (now() - lastGrowth_);
+    if (idle <= 0) return false;
+    if (idle < left) left = idle;
+  }
+  int ms = (int)(left * 1000) + 1;
+
+  if (inotify_ < 0) {
+    poll(NULL, 0, ms);
+    return !gStop;
+  }
+  struct pollfd p = { inotify_, POLLIN, 0 };
+  if (poll(&p, 1, ms) > 0) {
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    while ((n = ::read(inotify_, events, sizeof events)) > 0)
+      for (char* e = events; e < events + n; e += sizeof(struct inotify_event) + ((struct inotify_event*)e)->len)
+        if (((struct inotify_event*)e)->mask & (IN_MOVE_SELF | IN_IGNORED))
+          return false;                         // renamed away
+  }
+  return !gStop;
+}
@@ -0,0 +1,65 @@
+//*****************************************************************************
+// purpose: follow a growing CSV file for Lab 1 (lex --follow[=SECONDS])
+// version: Fall 2024
+//
+// FollowSource is a ChunkSource (source.h) that does not end at the end of
+// the file. It remembers the byte offset just after the last complete line
+// it handed out (the scanner remembers the line number) and reads from
+// there with pread, so nothing is scanned twice. A partial last line stays
+// in the file until its newline arrives. When there is nothing new,
+// next() sleeps on inotify (IN_MODIFY and friends) and wakes as soon as
+// the file is appended to; without inotify it checks the size every
+// 200 ms.
+//
+// Following stops, and the remaining bytes are handed out as the last
+// buffer, when the file has not grown for SECONDS (--follow=SECONDS), when
+// it is deleted or renamed, or on SIGINT / SIGTERM
+// (follow_stop_on_signals()). A file that shrinks was truncated or
+// replaced: next() fails with an error, since the counts so far no longer
+// describe it.
+//*****************************************************************************
+#ifndef FOLLOW_H
+#define FOLLOW_H
+
+#include <sys/types.h>
+#include <vector>
+#include "source.h"
+
+class FollowSource : public ChunkSource
+{
+public:
+  static const size_t kReadSize = 4 << 20;   // bytes per read
+
+  FollowSource();
+  ~FollowSource();
+
+  // idleSeconds < 0: follow until a signal or until the file goes away
+  bool open( const char* path, double idleSeconds );
+  bool next( const char*& begin, const char*& end );
+
+  off_t offset() const { return offset_; }   // just after the last line handed out
+  bool  caughtUp() const { return caughtUp_; }  // that was the end of the file
+
+private:
+  bool wait();   // until the file may have grown; false: stop following
+
+  int               fd_;
+  int               inotify_;
+  double            idle_;       // seconds without growth before stopping
+  double            lastGrowth_; // when the file last grew
+  off_t             offset_;     // file offset of buf_[handed_]
+  std::vector<char> buf_;        // bytes read from the file, from offset_ - handed_
+  size_t            have_;       // bytes in buf_
+  size_t            handed_;     // bytes of buf_ handed out by the last next()
+  bool              stopping_;   // hand out the rest, then end
+  bool              done_;
+  bool              caughtUp_;
+};
+
+// Can `path` be followed (a regular file, not gzip)? If not, why not
+bool follow_check( const char* path, std::string& error );
+
+// SIGINT and SIGTERM end --follow cleanly (the totals are still printed)
+void follow_stop_on_signals();
+
+#endif
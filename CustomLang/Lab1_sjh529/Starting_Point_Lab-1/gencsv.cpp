@@ -0,0 +1,416 @@
+//*****************************************************************************
+// purpose: synthetic case-extract generator for Lab 1 scanner tests
+// version: Fall 2024
+//
+//   gencsv [--rows=N | --size=BYTES[K|M|G]] [--seed=S] [--malformed=F]
+//          [--unknown=F] [--expected=FILE] [--expected-resync=FILE]
+//          [-o FILE]
+//
+// Writes rows in the schema of sample.csv (12 columns, see records.h) with
+// the quirks of the fixtures: mixed case ("probable case", "female"),
+// leading and trailing blanks, CRLF line ends, blank lines, quoted
+// ethnicity values with commas, empty fields and Missing/Unknown values.
+//
+//   --malformed=F  fraction of rows that still tokenize but that --records
+//                  rejects: too few or too many fields, a value in the
+//                  wrong column, a date that is not a calendar day
+//                  (2020/02/30), two tokens in one field
+//   --unknown=F    fraction of rows with a field the scanner cannot match
+//                  (N/A, ?, #)
+//   --expected     write what `lex --count` prints for the file after its
+//                  INFO line: the token counts, or the first unknown token
+//                  and the error
+//   --expected-resync  the same for `lex --resync --count` (resync.h)
+//
+// A summary ("rows", "malformed", "unknown", "bytes") goes to stderr.
+// The output is the same for the same seed and options.
+//*****************************************************************************
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "lexer.h"
+#include "records.h"
+#include "resync.h"
+#include "tally.h"
+
+namespace
+{
+
+struct Spelling
+{
+  const char* text;
+  int         code;
+};
+
+// Spellings per column; repeats weight the common values
+const Spelling kStatus[] = {
+  { "Laboratory-confirmed case", LABORATORY }, { "Laboratory-confirmed case", LABORATORY },
+  { "Laboratory-confirmed case", LABORATORY }, { "laboratory-confirmed Case", LABORATORY },
+  { "Probable Case", PROBABLE }, { "probable case", PROBABLE },
+  { "Missing", MISSING }, { "Unknown", UNKNOWN_VALUE },
+};
+const Spelling kSex[] = {
+  { "Female", FEMALE }, { "Female", FEMALE }, { "female", FEMALE },
+  { "Male", MALE }, { "Male", MALE }, { "male", MALE },
+  { "Other", OTHER }, { "Unknown", UNKNOWN_VALUE }, { "Missing", MISSING },
+};
+const Spelling kAge[] = {
+  { "0 - 9 Years", AGE_0X }, { "10 - 19 Years", AGE_1X }, { "10 - 19 years", AGE_1X },
+  { "20 - 39 Years", AGE_2X }, { "20 - 39 Years", AGE_2X }, { "40 - 49 Years", AGE_4X },
+  { "50 - 59 Years", AGE_5X }, { "60 - 69 Years", AGE_6X }, { "70 - 79 Years", AGE_7X },
+  { "80+ Years", AGE_8X }, { "80+ years", AGE_8X }, { "Missing", MISSING },
+};
+const Spelling kEthnicity[] = {
+  { "\"Hispanic/Latino\"", HISPANIC }, { "\"hispanic/Latino\"", HISPANIC },
+  { "\"American Indian / Alaska Native, Non-Hispanic\"", NATIVE_AMERICAN },
+  { "\"Asian, Non-Hispanic\"", ASIAN }, { "\"Black, Non-Hispanic\"", BLACK },
+  { "\"black, non-Hispanic\"", BLACK },
+  { "\"Native Hawaiian / Other Pacific Islander, Non-Hispanic\"", PACIFIC_ISLANDER },
+  { "\"White, Non-Hispanic\"", WHITE }, { "\"White, Non-Hispanic\"", WHITE },
+  { "\"white, Non-Hispanic\"", WHITE }, { "\"Multiple/Other, Non-Hispanic\"", MULTIPLE_OTHER },
+  { "Unknown", UNKNOWN_VALUE }, { "Unknown", UNKNOWN_VALUE }, { "Missing", MISSING },
+};
+const Spelling kYesNo[] = {
+  { "No", NO }, { "No", NO }, { "no", NO }, { "Yes", YES }, { "yes", YES },
+  { "Missing", MISSING }, { "Missing", MISSING }, { "Unknown", UNKNOWN_VALUE },
+};
+
+struct Choices
+{
+  const Spelling* spellings;
+  int             count;
+};
+
+#define CHOICES(a) { a, (int)(sizeof a / sizeof a[0]) }
+const Choices kColumns[8] = {
+  CHOICES(kStatus), CHOICES(kSex), CHOICES(kAge), CHOICES(kEthnicity),
+  CHOICES(kYesNo), CHOICES(kYesNo), CHOICES(kYesNo), CHOICES(kYesNo),
+};
+#undef CHOICES
+
+const char* const kBlanks[] = { " ", "  ", "\t", "     " };
+const char* const kUnknown[] = { "N/A", "?", "#" };   // first byte is the lexeme
+
+// xorshift64*: fast and the same on every platform
+struct Random
+{
+  uint64_t s;
+  explicit Random( uint64_t seed ) : s(seed * 2654435761u + 0x9E3779B97F4A7C15ull) {}
+  uint64_t next()
+  {
+    s ^= s >> 12; s ^= s << 25; s ^= s >> 27;
+    return s * 2685821657736338717ull;
+  }
+  int below( int n ) { return (int)(((next() >> 32) * (uint64_t)n) >> 32); }
+  bool chance( double p ) { return (next() >> 11) * (1.0 / 9007199254740992.0) < p; }
+};
+
+// One field: text plus the tokens it scans to
+struct Field
+{
+  const char* text;
+  int         codes[2];
+  int         tokens;
+};
+
+const int kDays = 3 * 365;   // dates are days of 2020 .. 2022
+
+class Generator
+{
+public:
+  Generator( uint64_t seed, double malformed, double unknown )
+    : random_(seed), malformed_(malformed), unknown_(unknown), line_(1),
+      rows_(0), badRows_(0), unknownRows_(0), firstUnknownLine_(0),
+      firstUnknown_(0)
+  {
+    // "YYYY/MM/DD" of every day, so a row needs no formatting
+    int y = 2020, m = 1, d = 1;
+    for (int i = 0; i < kDays; i++) {
+      // the % keeps every field to its width (y stays far below 10000)
+      snprintf(dates_[i], sizeof dates_[i], "%04u/%02u/%02u",
+               (unsigned)y % 10000u, (unsigned)m % 100u, (unsigned)d % 100u);
+      int last = m == 2 ? (y % 4 == 0 ? 29 : 28)
+               : (m == 4 || m == 6 || m == 9 || m == 11) ? 30 : 31;
+      if (++d > last) {
+        d = 1;
+        if (++m > 12) m = 1, y++;
+      }
+    }
+  }
+
+  // Append one row (and maybe a blank line) to `out`
+  void row( std::string& out );
+
+  long rows() const { return rows_; }
+  long malformedRows() const { return badRows_; }
+  long unknownRows() const { return unknownRows_; }
+
+  // What `lex --count` prints after the INFO line
+  void writeExpected( FILE* f ) const;
+  // ... and `lex --resync --count`
+  void writeExpectedResync( FILE* f ) const;
+
+private:
+  void date( Field& f, int empty );
+  void value( Field& f, int col );
+  void emit( std::string& out, const Field& f, bool separator );
+
+  Random random_;
+  double malformed_;
+  double unknown_;
+  int    line_;
+  Tally  tally_;      // tokens up to the first unknown byte
+  Tally  clean_;      // tokens of the rows without unknown bytes
+  ErrorLog errors_;   // rows with unknown bytes
+  int    codes_[2 * COL_COUNT + 4];   // tokens of the current row
+  int    count_;
+  long   rows_;
+  long   badRows_;
+  long   unknownRows_;
+  int    firstUnknownLine_;
+  char   firstUnknown_;
+  char   dates_[kDays][11];
+};
+
+void Generator::date( Field& f, int emptyPercent )
+{
+  f.tokens = 0;
+  f.text = "";
+  if (random_.below(100) < emptyPercent) return;
+  f.text = dates_[random_.below(kDays)];
+  f.codes[0] = DATE;
+  f.tokens = 1;
+}
+
+void Generator::value( Field& f, int col )
+{
+  const Choices& c = kColumns[col - kDateColumns];
+  if (random_.below(100) < 4) {   // empty field
+    f.text = "";
+    f.tokens = 0;
+    return;
+  }
+  const Spelling& s = c.spellings[random_.below(c.count)];
+  f.text = s.text;
+  f.codes[0] = s.code;
+  f.tokens = 1;
+}
+
+void Generator::emit( std::string& out, const Field& f, bool separator )
+{
+  if (separator) {
+    out += ',';
+    codes_[count_++] = SEPARATOR;
+  }
+  bool blank = random_.below(100) < 6;
+  if (blank) out += kBlanks[random_.below(4)];
+  out += f.text;
+  if (blank && random_.below(2)) out += kBlanks[random_.below(4)];
+  for (int i = 0; i < f.tokens; i++) codes_[count_++] = f.codes[i];
+}
+
+void Generator::row( std::string& out )
+{
+  Field fields[COL_COUNT + 1];
+  int n = COL_COUNT;
+  date(fields[COL_CASE_DATE], 0);
+  date(fields[COL_REPORT_DATE], 10);
+  date(fields[COL_SPECIMEN_DATE], 50);
+  date(fields[COL_ONSET_DATE], 30);
+  for (int c = kDateColumns; c < COL_COUNT; c++) value(fields[c], c);
+
+  if (random_.chance(malformed_)) {
+    badRows_++;
+    switch (random_.below(5)) {
+      case 0:   // too few fields
+        n -= 1 + random_.below(3);
+        break;
+      case 1:   // too many
+        fields[n].text = "Yes";
+        fields[n].codes[0] = YES;
+        fields[n++].tokens = 1;
+        break;
+      case 2:   // a value in the wrong column
+        fields[COL_SEX].text = "Yes";
+        fields[COL_SEX].codes[0] = YES;
+        fields[COL_SEX].tokens = 1;
+        break;
+      case 3:   // not a calendar day
+        fields[COL_CASE_DATE].text = random_.below(2) ? "2020/02/30" : "2021/13/01";
+        fields[COL_CASE_DATE].codes[0] = DATE;
+        fields[COL_CASE_DATE].tokens = 1;
+        break;
+      default:  // two tokens in one field
+        fields[COL_HOSP].text = "Yes No";
+        fields[COL_HOSP].codes[0] = YES;
+        fields[COL_HOSP].codes[1] = NO;
+        fields[COL_HOSP].tokens = 2;
+        break;
+    }
+  }
+
+  int unknownField = -1;
+  if (random_.chance(unknown_)) {
+    unknownRows_++;
+    unknownField = kDateColumns + random_.below(COL_COUNT - kDateColumns);
+    if (unknownField >= n) unknownField = n - 1;
+  }
+
+  size_t start = out.size();
+  int unknownAt = -1;        // tokens before the unknown byte
+  char unknownByte = 0;
+  count_ = 0;
+  for (int i = 0; i < n; i++) {
+    if (i == unknownField) {
+      const char* text = kUnknown[random_.below(3)];
+      if (i > 0) {
+        out += ',';
+        codes_[count_++] = SEPARATOR;
+      }
+      unknownAt = count_;
+      unknownByte = text[0];
+      out += text;
+      continue;
+    }
+    emit(out, fields[i], i > 0);
+  }
+  const char* eol = random_.below(100) < 5 ? "\r\n" : "\n";
+  out += eol;
+
+  // lex --count stops at the first unknown byte: it counts the tokens
+  // before it, then nothing more. lex --resync drops the whole row.
+  if (!firstUnknown_) {
+    for (int i = 0; i < (unknownAt < 0 ? count_ : unknownAt); i++)
+      tally_.add(codes_[i], line_);
+    if (unknownAt >= 0) {
+      firstUnknown_ = unknownByte;
+      firstUnknownLine_ = line_;
+    }
+  }
+  if (unknownAt < 0)
+    for (int i = 0; i < count_; i++) clean_.add(codes_[i], line_);
+  else
+    errors_.add(line_, out.data() + start, out.data() + out.size() - 1,
+                unknownField, (unsigned char)unknownByte);
+
+  rows_++;
+  line_++;
+  if (random_.below(1000) == 0) {
+    out += '\n';
+    line_++;
+  }
+}
+
+void Generator::writeExpected( FILE* f ) const
+{
+  if (firstUnknown_) {
+    fprintf(f, "line: %d  lexeme: |%c|  length: 1  token: UNKNOWN_TOKEN\n", firstUnknownLine_, firstUnknown_);
+    fprintf(f, "ERROR: unknown token\n");
+    return;
+  }
+  fprintf(f, "Found end of file...\n");
+  print_counts(tally_, f);
+}
+
+void Generator::writeExpectedResync( FILE* f ) const
+{
+  fprintf(f, "Found end of file...\n");
+  print_counts(clean_, f);
+  print_errors(errors_, NULL, f);
+}
+
+// "10G", "512M", "64K" or a plain number of bytes
+long long parse_size( const char* s )
+{
+  char* end;
+  double v = strtod(s, &end);
+  switch (*end) {
+    case 'K': case 'k': v *= 1024; break;
+    case 'M': case 'm': v *= 1024 * 1024; break;
+    case 'G': case 'g': v *= 1024.0 * 1024 * 1024; break;
+    default: break;
+  }
+  return (long long)v;
+}
+
+} // namespace
+
+int main( int argc, char* argv[] )
+{
+  long long rows = -1, size = -1;
+  unsigned long seed = 1;
+  double malformed = 0, unknown = 0;
+  const char* expected = NULL;
+  const char* expectedResync = NULL;
+  const char* output = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--rows=", 7) == 0)
+      rows = atoll(argv[i] + 7);
+    else if (strncmp(argv[i], "--size=", 7) == 0)
+      size = parse_size(argv[i] + 7);
+    else if (strncmp(argv[i], "--seed=", 7) == 0)
+      seed = strtoul(argv[i] + 7, NULL, 10);
+    else if (strncmp(argv[i], "--malformed=", 12) == 0)
+      malformed = atof(argv[i] + 12);
+    else if (strncmp(argv[i], "--unknown=", 10) == 0)
+      unknown = atof(argv[i] + 10);
+    else if (strncmp(argv[i], "--expected=", 11) == 0)
+      expected = argv[i] + 11;
+    else if (strncmp(argv[i], "--expected-resync=", 18) == 0)
+      expectedResync = argv[i] + 18;
+    else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      output = argv[++i];
+    else {
+      fprintf(stderr, "usage: %s [--rows=N | --size=BYTES[K|M|G]] [--seed=S]\n"
+                      "       [--malformed=F] [--unknown=F] [--expected=FILE]\n"
+                      "       [--expected-resync=FILE] [-o FILE]\n", argv[0]);
+      return (-1);
+    }
+  }
+  if (rows < 0 && size < 0) rows = 1000;
+
+  FILE* out = output ? fopen(output, "wb") : stdout;
+  if (!out) {
+    perror(output);
+    return (-1);
+  }
+
+  Generator gen(seed, malformed, unknown);
+  std::string buffer;
+  long long bytes = 0;
+  while (rows < 0 || gen.rows() < rows) {
+    gen.row(buffer);
+    if (buffer.size() >= (1 << 20)) {
+      fwrite(buffer.data(), 1, buffer.size(), out);
+      bytes += buffer.size();
+      buffer.clear();
+    }
+    // stop at the size without writing a partial row
+    if (size >= 0 && bytes + (long long)buffer.size() >= size) break;
+  }
+  fwrite(buffer.data(), 1, buffer.size(), out);
+  bytes += buffer.size();
+  if (output && fclose(out) != 0) {
+    perror(output);
+    return (-1);
+  }
+
+  for (int k = 0; k < 2; k++) {
+    const char* path = k ? expectedResync : expected;
+    if (!path) continue;
+    FILE* f = fopen(path, "w");
+    if (!f) {
+      perror(path);
+      return (-1);
+    }
+    if (k) gen.writeExpectedResync(f);
+    else gen.writeExpected(f);
+    fclose(f);
+  }
+  fprintf(stderr, "rows: %ld  malformed: %ld  unknown: %ld  bytes: %lld\n",
+          gen.rows(), gen.malformedRows(), gen.unknownRows(), bytes);
+  return 0;
+}
@@ -0,0 +1,135 @@
+//*****************************************************************************
+// purpose: gzip input for the Lab 1 engines - see gzsource.h
+// version: Fall 2024
+//*****************************************************************************
+#include "gzsource.h"
+
+#include <string.h>
+#include <zlib.h>
+
+GzipSource::GzipSource()
+  : gz_(NULL), filledCount_(0), freeCount_(2), current_(-1),
+    finished_(false), stop_(false)
+{
+  free_[0] = 0;
+  free_[1] = 1;
+}
+
+GzipSource::~GzipSource()
+{
+  if (worker_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    changed_.notify_all();
+    worker_.join();
+  }
+  if (gz_) gzclose((gzFile)gz_);
+}
+
+bool GzipSource::open( const char* path )
+{
+  gzFile f = gzopen(path, "rb");
+  if (!f) return false;
+  gzbuffer(f, 256 << 10);
+  gz_ = f;
+  for (int i = 0; i < 2; i++)
+    buffers_[i].data.resize(kBufferSize);
+  worker_ = std::thread(&GzipSource::inflate_loop, this);
+  return true;
+}
+
+// Worker thread: fill a free buffer with whole lines, queue it, repeat
+void GzipSource::inflate_loop()
+{
+  gzFile f = (gzFile)gz_;
+  std::vector<char> carry;   // partial last line of the previous buffer
+
+  for (bool last = false; !last; ) {
+    int index;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      changed_.wait(lock, [&] { return freeCount_ > 0 || stop_; });
+      if (stop_) return;
+      index = free_[--freeCount_];
+    }
+
+    Buffer& b = buffers_[index];
+    if (b.data.size() < carry.size() * 2)
+      b.data.resize(carry.size() * 2);
+    if (!carry.empty())
+      memcpy(&b.data[0], &carry[0], carry.size());
+    size_t used = carry.size();
+    std::string error;
+
+    // read until the buffer is full; a buffer without any newline holds
+    // part of one very long line, so it grows instead
+    for (;;) {
+      while (used < b.data.size()) {
+        unsigned want = b.data.size() - used > (1u << 30) ? 1u << 30 : b.data.size() - used;
+        int n = gzread(f, &b.data[used], want);
+        int code = Z_OK;
+        const char* message = n <= 0 ? gzerror(f, &code) : NULL;
+        // a truncated file ends with a short read and Z_BUF_ERROR
+        if (n < 0 || (code != Z_OK && code != Z_STREAM_END)) {
+          error = std::string("gzip: ") + message;
+          break;
+        }
+        if (n == 0) break;
+        used += n;
+      }
+      if (used < b.data.size() || !error.empty()) {
+        last = true;
+        break;
+      }
+      if (memchr(&b.data[0], '\n', used)) break;
+      b.data.resize(b.data.size() * 2);
+    }
+
+    // cut after the last newline and keep the rest for the next buffer;
+    // after an error the partial last line is incomplete, so drop it too
+    size_t size = used;
+    if (!last || !error.empty()) {
+      while (size > 0 && b.data[size - 1] != '\n') size--;
+    }
+    carry.assign(b.data.begin() + size, b.data.begin() + used);
+    b.size = size;
+    b.last = last;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      filled_[filledCount_++] = index;
+      if (!error.empty()) workerError_ = error;
+    }
+    changed_.notify_all();
+  }
+}
+
+bool GzipSource::next( const char*& begin, const char*& end )
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (current_ >= 0) {
+    free_[freeCount_++] = current_;
+    current_ = -1;
+    changed_.notify_all();
+  }
+  if (finished_) return false;
+
+  changed_.wait(lock, [&] { return filledCount_ > 0; });
+  current_ = filled_[0];
+  filled_[0] = filled_[1];
+  filledCount_--;
+
+  const Buffer& b = buffers_[current_];
+  finished_ = b.last;
+  if (b.last && !workerError_.empty()) {
+    // hand out the whole lines read before the error; the next call
+    // returns false and the caller reports error()
+    error_ = workerError_;
+    if (b.size == 0) return false;
+  }
+  begin = &b.data[0];
+  end = begin + b.size;
+  return true;
+}
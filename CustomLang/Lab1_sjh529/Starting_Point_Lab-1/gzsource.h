@@ -0,0 +1,58 @@
+//*****************************************************************************
+// purpose: gzip input for the Lab 1 engines (lex file.csv.gz)
+// version: Fall 2024
+//
+// A worker thread inflates the file with zlib into two buffers while the
+// scanner works on the other one, so inflating and tokenizing overlap and
+// no temporary file is written. Each buffer is cut after its last newline;
+// the partial line is carried over to the start of the next buffer. A
+// line longer than a buffer makes the buffers grow. Input that is not gzip
+// is passed through as is (zlib's transparent mode), which is how pipes
+// are read.
+//*****************************************************************************
+#ifndef GZSOURCE_H
+#define GZSOURCE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "source.h"
+
+class GzipSource : public ChunkSource
+{
+public:
+  static const size_t kBufferSize = 4 << 20;
+
+  GzipSource();
+  ~GzipSource();
+
+  bool open( const char* path );
+  bool next( const char*& begin, const char*& end );
+
+private:
+  struct Buffer
+  {
+    std::vector<char> data;
+    size_t            size;     // bytes of whole lines
+    bool              last;     // end of input (or error) after this one
+  };
+
+  void inflate_loop();
+
+  void*                   gz_;        // gzFile
+  Buffer                  buffers_[2];
+  int                     filled_[2]; // queue of filled buffer indexes
+  int                     filledCount_;
+  int                     free_[2];
+  int                     freeCount_;
+  int                     current_;   // buffer the scanner holds, or -1
+  bool                    finished_;
+  bool                    stop_;
+  std::string             workerError_;
+  std::mutex              mutex_;
+  std::condition_variable changed_;
+  std::thread             worker_;
+};
+
+#endif
@@ -0,0 +1,435 @@
+//*****************************************************************************
+// purpose: multi-file input for Lab 1 - see ingest.h
+// version: Fall 2024
+//*****************************************************************************
+#include "ingest.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <glob.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "fastscan.h"
+#include "source.h"
+
+static bool ends_with( const std::string& s, const char* suffix )
+{
+  size_t n = strlen(suffix);
+  return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static bool is_directory( const char* path )
+{
+  struct stat st;
+  return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool is_multi_input( const char* arg )
+{
+  struct stat st;
+  if (stat(arg, &st) == 0) return S_ISDIR(st.st_mode);
+  return strpbrk(arg, "*?[") != NULL;
+}
+
+bool expand_inputs( const char* arg, std::vector<std::string>& files, std::string& error )
+{
+  struct stat st;
+  if (is_directory(arg)) {
+    DIR* dir = opendir(arg);
+    if (!dir) {
+      error = std::string("cannot read directory ") + arg;
+      return false;
+    }
+    std::string prefix(arg);
+    if (prefix.empty() || prefix[prefix.size() - 1] != '/') prefix += '/';
+    std::vector<std::string> found;
+    for (struct dirent* e; (e = readdir(dir)) != NULL; ) {
+      std::string name = e->d_name;
+      if (name[0] == '.' || !(ends_with(name, ".csv") || ends_with(name, ".csv.gz")))
+        continue;
+      std::string path = prefix + name;
+      if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+        found.push_back(path);
+    }
+    closedir(dir);
+    if (found.empty()) {
+      error = std::string("no .csv or .csv.gz files in ") + arg;
+      return false;
+    }
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+    return true;
+  }
+  if (stat(arg, &st) == 0) {
+    files.push_back(arg);
+    return true;
+  }
+
+  glob_t g;
+  if (glob(arg, 0, NULL, &g) != 0) {
+    error = std::string("no input files match ") + arg;
+    return false;
+  }
+  for (size_t i = 0; i < g.gl_pathc; i++)
+    if (stat(g.gl_pathv[i], &st) == 0 && S_ISREG(st.st_mode))
+      files.push_back(g.gl_pathv[i]);
+  globfree(&g);
+  return true;
+}
+
+IngestResult::IngestResult()
+  : files(0), bytes(0), steals(0)
+{
+  counts.rows = counts.matched = 0;
+  stats.rejected = stats.badDates = 0;
+  stats.firstRejectedLine = 0;
+}
+
+namespace
+{
+
+// A whole file (chunk < 0) or one chunk of a file that has been cut
+struct Task
+{
+  size_t      file;
+  int         chunk;
+  const char* begin;
+  const char* end;
+  int         firstLine;
+};
+
+// Result of one task
+struct Part
+{
+  size_t        bytes;
+  Tally         tally;
+  QueryCounts   counts;
+  RecordColumns columns;
+  RecordStats   stats;
+  ErrorLog      log;
+  std::string   error;   // set when the file has to be left out
+};
+
+struct FileState
+{
+  ChunkSource*      src;    // open while chunks of it are pending
+  std::atomic<int>  left;   // chunks not finished yet (+1 while cutting)
+  std::vector<Part> parts;  // one per chunk, or one for the whole file
+  size_t            used;   // parts filled in
+};
+
+// One deque of tasks per worker (see ingest.h)
+class TaskQueues
+{
+public:
+  explicit TaskQueues( int workers ) : queues_(workers), pending_(0), steals_(0) {}
+
+  void push( int worker, const Task& t )
+  {
+    pending_++;
+    {
+      std::lock_guard<std::mutex> hold(queues_[worker].lock);
+      queues_[worker].tasks.push_back(t);
+    }
+    wake_.notify_one();
+  }
+
+  // The newest task of `worker`, else the oldest task of another worker
+  bool take( int worker, Task& t )
+  {
+    if (popBack(queues_[worker], t)) return true;
+    for (size_t i = 1; i < queues_.size(); i++)
+      if (popFront(queues_[(worker + i) % queues_.size()], t)) {
+        steals_++;
+        return true;
+      }
+    return false;
+  }
+
+  // A taken task is finished (it may have pushed others first)
+  void done()
+  {
+    if (--pending_ == 0) wake_.notify_all();
+  }
+
+  // Wait a little for a task to show up; false once every task is done
+  bool wait()
+  {
+    if (pending_ == 0) return false;
+    std::unique_lock<std::mutex> hold(idle_);
+    wake_.wait_for(hold, std::chrono::milliseconds(1));
+    return pending_ != 0;
+  }
+
+  long steals() const { return steals_; }
+
+private:
+  struct Queue
+  {
+    std::mutex       lock;
+    std::deque<Task> tasks;
+  };
+
+  static bool popBack( Queue& q, Task& t )
+  {
+    std::lock_guard<std::mutex> hold(q.lock);
+    if (q.tasks.empty()) return false;
+    t = q.tasks.back();
+    q.tasks.pop_back();
+    return true;
+  }
+
+  static bool popFront( Queue& q, Task& t )
+  {
+    std::lock_guard<std::mutex> hold(q.lock);
+    if (q.tasks.empty()) return false;
+    t = q.tasks.front();
+    q.tasks.pop_front();
+    return true;
+  }
+
+  std::vector<Queue>      queues_;
+  std::atomic<long>       pending_;   // pushed and not done
+  std::atomic<long>       steals_;
+  std::mutex              idle_;
+  std::condition_variable wake_;
+};
+
+// Feed the tokens to the tally or to the record builder; an unknown
+// token ends the part with an error
+template <class Scanner>
+void scan_tokens( Scanner& scanner, Part& part, RecordBuilder* builder )
+{
+  ScanToken tok;
+  while (scanner.next(tok) != EOF_TOKEN) {
+    if (tok.code == UNKNOWN_TOKEN) {
+      char message[96];
+      snprintf(message, sizeof message, "line %d: unknown token |%.*s|",
+               tok.line, tok.length, tok.text);
+      part.error = message;
+      return;
+    }
+    if (builder) builder->add(tok);
+    else part.tally.add(tok.code, tok.line);
+  }
+}
+
+class Ingest
+{
+public:
+  Ingest( const std::vector<std::string>& files, const IngestOptions& opt )
+    : paths_(files), opt_(opt), files_(files.size()), queues_(opt.threads)
+  {
+  }
+
+  void run( IngestResult& result );
+
+private:
+  void work( int worker );
+  void openFile( int worker, const Task& t );
+  void scanChunk( const Task& t );
+  void finishChunk( FileState& f );
+  void startPart( Part& part );
+  void scan( const char* begin, const char* end, int& line, Part& part,
+             RecordBuilder* builder );
+  void merge( IngestResult& result );
+
+  const std::vector<std::string>& paths_;
+  const IngestOptions&            opt_;
+  std::vector<FileState>          files_;
+  TaskQueues                      queues_;
+};
+
+void Ingest::run( IngestResult& result )
+{
+  for (size_t i = 0; i < files_.size(); i++) {
+    files_[i].src = NULL;
+    files_[i].left = 0;
+    files_[i].used = 0;
+    Task t = { i, -1, NULL, NULL, 1 };
+    queues_.push(i % opt_.threads, t);
+  }
+  std::vector<std::thread> pool;
+  for (int w = 1; w < opt_.threads; w++)
+    pool.emplace_back(&Ingest::work, this, w);
+  work(0);
+  for (size_t w = 0; w < pool.size(); w++)
+    pool[w].join();
+  merge(result);
+  result.steals = queues_.steals();
+}
+
+void Ingest::work( int worker )
+{
+  Task t;
+  for (;;) {
+    if (queues_.take(worker, t)) {
+      if (t.chunk < 0) openFile(worker, t);
+      else scanChunk(t);
+      queues_.done();
+    }
+    else if (!queues_.wait())
+      return;
+  }
+}
+
+void Ingest::startPart( Part& part )
+{
+  part.bytes = 0;
+  part.tally = Tally(opt_.histColumn);
+  part.counts.rows = part.counts.matched = 0;
+  part.stats.rejected = part.stats.badDates = 0;
+  part.stats.firstRejectedLine = 0;
+  part.log.keepText = false;
+}
+
+// Scan [begin, end), which starts on `line`, into `part`
+void Ingest::scan( const char* begin, const char* end, int& line, Part& part,
+                   RecordBuilder* builder )
+{
+  part.bytes += end - begin;
+  if (opt_.mode == INGEST_QUERY) {
+    opt_.query->run(begin, end, line, part.counts, NULL, opt_.resync ? &part.log : NULL);
+    return;
+  }
+
+  if (opt_.resync) {
+    ResyncScanner scanner(begin, end, line, part.log);
+    scan_tokens(scanner, part, builder);
+    line = scanner.line();
+  }
+  else {
+    FastScanner scanner(begin, end, line);
+    scan_tokens(scanner, part, builder);
+    line = scanner.line();
+  }
+  if (builder) builder->finish();
+}
+
+// A whole-file task: cut a large mapped file into chunk tasks, or scan
+// the file here buffer by buffer
+void Ingest::openFile( int worker, const Task& t )
+{
+  FileState& f = files_[t.file];
+  ChunkSource* src = open_source(paths_[t.file].c_str());
+  f.parts.resize(1);
+  startPart(f.parts[0]);
+  f.used = 1;
+  if (!src) {
+    f.parts[0].error = "cannot open";
+    return;
+  }
+
+  const char* begin;
+  const char* end;
+  bool more = src->next(begin, end);
+  if (more && dynamic_cast<MappedSource*>(src) && (size_t)(end - begin) > 2 * opt_.chunkSize) {
+    size_t size = end - begin;
+    f.src = src;
+    f.parts.resize((size + opt_.chunkSize - 1) / opt_.chunkSize);
+    f.left = 1;
+    int line = 1;
+    size_t n = 0;
+    for (const char* p = begin; p < end; ) {
+      const char* last = p + std::min(opt_.chunkSize, (size_t)(end - p)) - 1;
+      const char* nl = (const char*)memchr(last, '\n', end - last);
+      Task c = { t.file, (int)n++, p, nl ? nl + 1 : end, line };
+      f.left++;
+      queues_.push(worker, c);
+      for (const char* q = p; (q = (const char*)memchr(q, '\n', c.end - q)) != NULL; q++)
+        line++;
+      p = c.end;
+    }
+    f.used = n;
+    finishChunk(f);
+    return;
+  }
+
+  // small, gzip or piped: one part, scanned in order
+  Part& part = f.parts[0];
+  RecordBuilder builder(part.columns);
+  RecordBuilder* records = opt_.mode == INGEST_RECORDS ? &builder : NULL;
+  int line = 1;
+  for (; more && part.error.empty(); more = src->next(begin, end))
+    if (end > begin) scan(begin, end, line, part, records);
+  if (part.error.empty() && !src->error().empty())
+    part.error = src->error();
+  part.stats.rejected = builder.rejected();
+  part.stats.firstRejectedLine = builder.firstRejectedLine();
+  part.stats.badDates = builder.badDates();
+  delete src;
+}
+
+void Ingest::scanChunk( const Task& t )
+{
+  FileState& f = files_[t.file];
+  Part& part = f.parts[t.chunk];
+  startPart(part);
+  RecordBuilder builder(part.columns);
+  int line = t.firstLine;
+  scan(t.begin, t.end, line, part, opt_.mode == INGEST_RECORDS ? &builder : NULL);
+  part.stats.rejected = builder.rejected();
+  part.stats.firstRejectedLine = builder.firstRejectedLine();
+  part.stats.badDates = builder.badDates();
+  finishChunk(f);
+}
+
+// The last chunk of a file to finish unmaps it
+void Ingest::finishChunk( FileState& f )
+{
+  if (--f.left == 0) {
+    delete f.src;
+    f.src = NULL;
+  }
+}
+
+void Ingest::merge( IngestResult& result )
+{
+  result.tally = Tally(opt_.histColumn);
+  for (size_t i = 0; i < files_.size(); i++) {
+    FileState& f = files_[i];
+    size_t p = 0;
+    while (p < f.used && f.parts[p].error.empty()) p++;
+    if (p < f.used) {
+      result.failures.push_back(paths_[i] + ": " + f.parts[p].error);
+      f.parts.clear();
+      continue;
+    }
+    result.files++;
+    for (p = 0; p < f.used; p++) {
+      Part& part = f.parts[p];
+      result.bytes += part.bytes;
+      result.tally.merge(part.tally);
+      result.counts.rows += part.counts.rows;
+      result.counts.matched += part.counts.matched;
+      result.errors.merge(part.log);
+      result.columns.append(part.columns);
+      if (part.stats.rejected && !result.stats.rejected) {
+        result.stats.firstRejectedLine = part.stats.firstRejectedLine;
+        result.firstRejectedFile = paths_[i];
+      }
+      result.stats.rejected += part.stats.rejected;
+      result.stats.badDates += part.stats.badDates;
+    }
+    f.parts.clear();
+  }
+}
+
+} // namespace
+
+void ingest_files( const std::vector<std::string>& files, const IngestOptions& opt,
+                   IngestResult& result )
+{
+  IngestOptions o = opt;
+  if (o.threads < 1) o.threads = 1;
+  if (o.chunkSize < 1) o.chunkSize = 1;
+  Ingest ingest(files, o);
+  ingest.run(result);
+}
@@ -0,0 +1,79 @@
+//*****************************************************************************
+// purpose: multi-file input for Lab 1 (lex DIR, lex 'data/*.csv', lex A B C)
+// version: Fall 2024
+//
+// CSV extracts arrive as many daily files. Given a directory, a quoted
+// glob or several file names, the driver hands the list to ingest_files(),
+// which scans the files concurrently and merges their aggregates.
+//
+// Scheduling is work stealing: every worker has a deque of tasks and the
+// files are dealt round-robin into those deques. A worker pops tasks from
+// the back of its own deque and, when that is empty, steals from the front
+// of another's. A task is either a whole file or one newline-aligned
+// chunk of a large file: the worker that opens a mapped file bigger than
+// two chunks cuts it (see parallel.h for why a newline is a safe cut) and
+// pushes the chunks onto its own deque, where idle workers steal them.
+// Gzip files stream through one worker.
+//
+// Every file or chunk produces a part; the parts are merged in file order,
+// so the totals and columns are the same for any number of threads. A file
+// with an unknown token (or that cannot be read) is reported by name and
+// left out of the totals; the other files still count.
+//*****************************************************************************
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "query.h"
+#include "records.h"
+#include "resync.h"
+#include "tally.h"
+
+// The files named by `arg`: the regular *.csv and *.csv.gz files of a
+// directory (sorted by name), the matches of a glob pattern, or the file
+// itself. False with a message in `error` when nothing matches.
+bool expand_inputs( const char* arg, std::vector<std::string>& files, std::string& error );
+
+// Does `arg` name several inputs (a directory or a pattern no file has)?
+bool is_multi_input( const char* arg );
+
+enum IngestMode
+{
+  INGEST_TALLY,     // --quiet, --count, --histogram
+  INGEST_QUERY,     // --where ... --count
+  INGEST_RECORDS    // --records, --write-columns
+};
+
+struct IngestOptions
+{
+  IngestMode   mode;
+  int          threads;      // workers (>= 1)
+  size_t       chunkSize;    // bytes per chunk of a large file
+  int          histColumn;   // INGEST_TALLY: --histogram column, or -1
+  const Query* query;        // INGEST_QUERY
+  bool         resync;       // skip lines with unknown tokens (resync.h)
+};
+
+struct IngestResult
+{
+  size_t        files;        // files scanned without an error
+  size_t        bytes;        // bytes scanned (inflated for .gz files)
+  long          steals;       // tasks taken from another worker's deque
+  Tally         tally;        // INGEST_TALLY
+  QueryCounts   counts;       // INGEST_QUERY
+  RecordColumns columns;      // INGEST_RECORDS, in file order
+  RecordStats   stats;        // INGEST_RECORDS
+  std::string   firstRejectedFile;
+  ErrorLog      errors;       // --resync: bad lines of every file
+  std::vector<std::string> failures;   // "FILE: message", in file order
+
+  IngestResult();
+};
+
+// Scan `files` as set by `opt` and merge the results into `result`
+void ingest_files( const std::vector<std::string>& files, const IngestOptions& opt,
+                   IngestResult& result );
+
+#endif
@@ -6,6 +6,10 @@ set -euo pipefail
 
 BIN="./lex"
 MAKE="make -s"
+# extra driver flags, e.g. LAB1_FLAGS=--simd to check the SIMD engine
+LAB1_FLAGS="${LAB1_FLAGS:-}"
+# LAB1_GZIP=1 runs every fixture gzipped (the driver reads .gz directly)
+LAB1_GZIP="${LAB1_GZIP:-}"
 
 # Pretty printing
 green() { printf "\033[32m%s\033[0m" "$*"; }
@@ -30,12 +34,32 @@ fi
 pass "Build complete"
 
 # Helpers
+GZ_DIR=""
+if [[ -n "$LAB1_GZIP" ]]; then
+  GZ_DIR="$(mktemp -d)"; trap 'rm -rf "$GZ_DIR"' EXIT
+fi
+
+# Run the driver on a fixture, gzipped first with LAB1_GZIP (the INFO line
+# names the fixture either way, so the same .out files apply)
+run_lex() {
+  local in="$1"
+  if [[ -z "$GZ_DIR" ]]; then
+    $BIN $LAB1_FLAGS "$in" 2>&1
+    return
+  fi
+  gzip -c "$in" > "$GZ_DIR/$in.gz"
+  local status=0
+  $BIN $LAB1_FLAGS "$GZ_DIR/$in.gz" > "$GZ_DIR/out" 2>&1 || status=$?
+  sed "s|$GZ_DIR/$in.gz|$in|" "$GZ_DIR/out"
+  return $status
+}
+
 run_good() {
   local in="$1"
   local expected="${2:-}"
   info "GOOD: $in"
   set +e
-  out=$($BIN "$in" 2>&1)
+  out=$(run_lex "$in")
   status=$?
   set -e
   if [[ $status -ne 0 ]]; then
@@ -65,7 +89,7 @@ run_bad() {
   local expected="${2:-}"
   info "BAD (should error): $in"
   set +e
-  out=$($BIN "$in" 2>&1)
+  out=$(run_lex "$in")
   status=$?
   set -e
   if ! echo "$out" | grep -q "ERROR"; then
@@ -122,6 +146,223 @@ for csv in *.csv; do
   fi
 done
 
+# --lenient ignores case and blanks in values (fieldclass.h); the fixture is
+# not a .csv because the rules alone reject it
+if [[ -f lenient_fields.dat ]]; then
+  LAB1_FLAGS="$LAB1_FLAGS --lenient" run_bad lenient_fields.dat lenient_fields.out || any_fail=1
+fi
+
+# Mode fixtures: NAME.MODE.out holds what one mode prints for NAME.csv,
+# without the INFO and timing lines (they change from run to run)
+mode_output() {
+  { $BIN "$@" 2>&1 || true; } | grep -v -E '^(INFO|build:|map:|wrote:|column scan:)' || true
+}
+
+check_mode() {
+  local expected="$1"; shift
+  info "MODE: $* ($expected)"
+  if diff -u "$expected" <(mode_output "$@"); then
+    pass "$expected matches"
+  else
+    fail "$expected does not match"
+    any_fail=1
+  fi
+}
+
+# --records (records.h): typed columns, row and reject counts
+check_mode sample.records.out --records sample.csv
+check_mode commas.records.out --records commas.csv
+# dates.dat: 2020/13/45 and 2021/02/29 are rejected, leap day 2020/02/29 is kept
+check_mode dates.records.out --records dates.dat
+# resync_rows.dat: sample.csv plus a "Femal" and an "N/A" row, which
+# --resync drops from records and queries instead of rejecting them
+check_mode resync_rows.records.out --records --resync resync_rows.dat
+# the same rows and rejects on several threads, chunk by chunk
+check_mode dates.records.out --records --threads=3 --chunk-size=64 dates.dat
+check_mode resync_rows.records.out --records --resync --threads=3 --chunk-size=64 resync_rows.dat
+check_mode resync_rows.where.out --where status=LABORATORY --count --resync resync_rows.dat
+
+# --write-columns / --read-columns (colfile.h): a column file read back
+# holds the same rows and filled counts that --records built
+ROUND_FILE="$(mktemp)"
+for name in sample commas; do
+  $BIN --write-columns="$ROUND_FILE" "$name.csv" > /dev/null
+  check_mode "$name.columns.out" --read-columns "$ROUND_FILE"
+  info "ROUND TRIP: $name.csv through a column file"
+  if diff -u <(mode_output --records "$name.csv" | sed '1s/  rejected:.*//') \
+             <(mode_output --read-columns "$ROUND_FILE"); then
+    pass "read back as --records built it"
+  else
+    fail "the column file differs from --records"
+    any_fail=1
+  fi
+done
+rm -f "$ROUND_FILE"
+
+# --count and --histogram=COLUMN (tally.h), with the engine under test
+for name in sample specific_data_good; do
+  check_mode "$name.count.out" $LAB1_FLAGS --count "$name.csv"
+done
+check_mode sample.histogram.out $LAB1_FLAGS --histogram=age_group sample.csv
+check_mode specific_data_good.histogram.out $LAB1_FLAGS --histogram=race_ethnicity specific_data_good.csv
+
+# Several inputs at once (ingest.h): a directory of the clean fixtures
+# counts the same as their concatenation, and a bad file is named
+MULTI_DIR="$(mktemp -d)"
+for csv in *.csv; do
+  out_file="${csv%.csv}.out"
+  if [[ -f "$out_file" ]] && ! grep -q "ERROR" "$out_file" && ! is_bad_by_pattern "$csv"; then
+    cp "$csv" "$MULTI_DIR/"
+    { cat "$csv"; echo; } >> "$MULTI_DIR/all.txt"
+  fi
+done
+info "MULTI: clean fixtures as one directory"
+expected=$($BIN --simd --count "$MULTI_DIR/all.txt" | tail -n +3)
+if diff -u <($BIN --count --threads=2 --chunk-size=64 "$MULTI_DIR" | sed '1d;$d') <(echo "$expected"); then
+  pass "directory counts match the concatenated files"
+else
+  fail "directory counts differ from the concatenated files"
+  any_fail=1
+fi
+cp another.csv "$MULTI_DIR/"
+set +e
+out=$($BIN --count "$MULTI_DIR" 2>&1)
+status=$?
+set -e
+if [[ $status -ne 0 ]] && echo "$out" | grep -q "^ERROR: $MULTI_DIR/another.csv: line "; then
+  pass "a bad file in the directory is reported by name"
+else
+  echo "$out"
+  fail "a bad file in the directory was not reported"
+  any_fail=1
+fi
+rm -rf "$MULTI_DIR"
+
+# --follow (follow.h): rows appended while the file is followed are scanned
+# once, with the same totals as the finished file
+FOLLOW_FILE="$(mktemp)"
+head -n 2 sample.csv > "$FOLLOW_FILE"
+( sleep 0.3; tail -n +3 sample.csv >> "$FOLLOW_FILE" ) &
+info "FOLLOW: sample.csv, appended to while followed"
+if diff -u <($BIN --follow=1 --count "$FOLLOW_FILE" | grep -v "^INFO") \
+           <($BIN --simd --count sample.csv | grep -v "^INFO"); then
+  pass "followed counts match the finished file"
+else
+  fail "followed counts differ from the finished file"
+  any_fail=1
+fi
+wait
+rm -f "$FOLLOW_FILE"
+
+DEDUP_FILE="$(mktemp)"
+{ cat sample.csv; echo; tr -s ' ' < sample.csv; } > "$DEDUP_FILE"
+info "DEDUP: sample.csv twice"
+if diff -u <($BIN --dedup "$DEDUP_FILE" | grep -v "^INFO" | sed '$d') sample.csv; then
+  pass "the second copy is dropped"
+else
+  fail "--dedup did not drop exactly the second copy"
+  any_fail=1
+fi
+rm -f "$DEDUP_FILE"
+
+COL_FILE="$(mktemp)"
+QUERY="report_date between 2020/06/01 and 2020/08/31 and sex=FEMALE|MALE"
+info "ZONES: --where over a column file of sample.csv"
+$BIN --write-columns="$COL_FILE" sample.csv > /dev/null
+if diff -u <($BIN --read-columns --count --where "$QUERY" "$COL_FILE" | grep "^rows") \
+           <($BIN --simd --count --where "$QUERY" sample.csv | grep "^rows") &&
+   $BIN --read-columns --count --where "case_date>2020/02/01" "$COL_FILE" | grep -q "skipped: 1 "; then
+  pass "column counts match, and a block out of range is skipped"
+else
+  fail "column file query differs from the CSV query"
+  any_fail=1
+fi
+rm -f "$COL_FILE"
+
+info "WHERE: --where with --records is refused, not ignored"
+set +e
+out=$($BIN --records --where "sex=FEMALE" --count sample.csv;
+      $BIN --write-columns=/dev/null --where "sex=FEMALE" sample.csv)
+set -e
+if [[ $(echo "$out" | grep -c "^ERROR: --where") -eq 2 ]]; then
+  pass "--where with --records / --write-columns is an error"
+else
+  fail "--where was accepted with --records / --write-columns"
+  any_fail=1
+fi
+
+info "RECORDS: --records with a token-count mode is refused, not ignored"
+set +e
+out=$($BIN --records --count sample.csv; $BIN --records --quiet sample.csv;
+      $BIN --records --histogram=sex sample.csv)
+set -e
+if [[ $(echo "$out" | grep -c "^ERROR: --records") -eq 3 ]]; then
+  pass "--records with --count / --quiet / --histogram is an error"
+else
+  fail "--records was accepted with --count / --quiet / --histogram"
+  any_fail=1
+fi
+
+# a bad number is a usage error naming the option, never "unknown option"
+BAD_NUMBERS=(--threads=0 --threads=x --chunk-size=0 --max-errors=abc --max-errors=-1
+             --follow=abc --follow=-1 --sample=0 --seed=xyz --seed=-1)
+info "NUMBERS: ${BAD_NUMBERS[*]}"
+bad_numbers=0
+for opt in "${BAD_NUMBERS[@]}"; do
+  set +e
+  out=$($BIN --simd "$opt" sample.csv)
+  status=$?
+  set -e
+  if [[ $status -eq 0 ]] || ! echo "$out" | grep -q "^ERROR: ${opt%%=*}=[A-Z]* needs"; then
+    fail "$opt was not reported as a bad value"
+    bad_numbers=1
+  fi
+done
+if [[ $bad_numbers -eq 0 ]]; then
+  pass "bad option values are usage errors"
+else
+  any_fail=1
+fi
+
+SKETCH_FILE="$(mktemp)"
+{ cat sample.csv; cat sample.csv; } > "$SKETCH_FILE"
+info "SKETCH: --distinct and --sample over sample.csv twice"
+out=$($BIN --distinct=row --distinct=sex --sample=4 "$SKETCH_FILE")
+if echo "$out" | grep -q "^distinct row: ~6 " && echo "$out" | grep -q "^distinct sex: ~2 " &&
+   [[ $(echo "$out" | grep -c "^line ") -eq 4 ]] &&
+   [[ "$out" == "$($BIN --threads=2 --chunk-size=64 --distinct=row --distinct=sex --sample=4 "$SKETCH_FILE")" ]]; then
+  pass "estimates are exact at this size, and the sample does not depend on --threads"
+else
+  fail "--distinct / --sample output is wrong"
+  any_fail=1
+fi
+rm -f "$SKETCH_FILE"
+
+GZ_FILE="$(mktemp)"
+GZ_LINES="$(mktemp)"
+gzip -c sample.csv | head -c -12 > "$GZ_FILE"   # cut into the last block
+info "GZIP: a truncated sample.csv.gz"
+set +e
+zcat "$GZ_FILE" 2>/dev/null | head -n "$(zcat "$GZ_FILE" 2>/dev/null | wc -l)" > "$GZ_LINES"
+out=$($BIN --simd "$GZ_FILE")
+set -e
+if diff -u <(echo "$out" | grep "^line") <($BIN --simd "$GZ_LINES" | grep "^line") &&
+   echo "$out" | tail -n 1 | grep -q "^ERROR: gzip: "; then
+  pass "the whole lines before the damage are scanned, then the error is reported"
+else
+  fail "truncated gzip input lost lines or hid the error"
+  any_fail=1
+fi
+rm -f "$GZ_FILE" "$GZ_LINES"
+
+info "URING: sample.csv read with --uring"
+if diff -u <($BIN --uring --simd sample.csv | grep -v "^INFO") <($BIN --simd sample.csv | grep -v "^INFO"); then
+  pass "same tokens as the mapped file"
+else
+  fail "--uring output differs"
+  any_fail=1
+fi
+
 if [[ $any_fail -eq 0 ]]; then
   pass "All tests passed expectations."
   exit 0
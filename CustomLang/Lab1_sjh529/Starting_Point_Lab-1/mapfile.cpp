@@ -0,0 +1,73 @@
+//*****************************************************************************
+// purpose: read-only view of a whole input file - see mapfile.h
+// version: Fall 2024
+//*****************************************************************************
+#include "mapfile.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::open(const char *path)
+{
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+  {
+    size_ = st.st_size;
+    if (size_ == 0)
+    {
+      ::close(fd);
+      return true;
+    }
+    void *p = mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED)
+    {
+      madvise(p, size_, MADV_SEQUENTIAL);
+      data_ = (char *)p;
+      mapped_ = true;
+      ::close(fd);
+      return true;
+    }
+    size_ = 0;
+  }
+
+  // not mappable: read it all
+  size_t cap = 1 << 20;
+  data_ = (char *)malloc(cap);
+  for (;;)
+  {
+    if (size_ == cap)
+    {
+      cap *= 2;
+      data_ = (char *)realloc(data_, cap);
+    }
+    ssize_t n = read(fd, data_ + size_, cap - size_);
+    if (n < 0)
+    {
+      ::close(fd);
+      close();
+      return false;
+    }
+    if (n == 0) break;
+    size_ += n;
+  }
+  ::close(fd);
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (mapped_)
+    munmap(data_, size_);
+  else
+    free(data_);
+  data_ = 0;
+  size_ = 0;
+  mapped_ = false;
+}
@@ -0,0 +1,36 @@
+//*****************************************************************************
+// purpose: read-only view of a whole input file for the Lab 1 fast engines
+// version: Fall 2024
+//
+// Regular files are mapped with mmap; anything that cannot be mapped
+// (pipes, /dev/stdin) is read into memory instead.
+//*****************************************************************************
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <stddef.h>
+
+class MappedFile
+{
+public:
+  MappedFile() : data_(0), size_(0), mapped_(false) {}
+  ~MappedFile() { close(); }
+
+  // false (with errno set) when the file cannot be opened or read
+  bool open(const char *path);
+  void close();
+
+  const char *data() const { return data_; }
+  size_t      size() const { return size_; }
+  const char *end()  const { return data_ + size_; }
+
+private:
+  MappedFile(const MappedFile &);
+  MappedFile &operator=(const MappedFile &);
+
+  char  *data_;
+  size_t size_;
+  bool   mapped_;
+};
+
+#endif
@@ -0,0 +1,227 @@
+//*****************************************************************************
+// purpose: multi-threaded tokenization for Lab 1 - see parallel.h
+// version: Fall 2024
+//*****************************************************************************
+#include "parallel.h"
+
+#include <string>
+#include "tokens.h"
+
+// Log for one chunk of a --resync run: same budget (a chunk over it is
+// over it overall), bad lines kept as text for ErrorLog::merge()
+static void start_chunk_log( ErrorLog& log, const ErrorLog& errors )
+{
+  log = ErrorLog();
+  log.budget = errors.budget;
+  log.keepText = errors.quarantine != NULL || errors.keepText;
+}
+
+// A chunk whose bad lines run the log over budget is scanned again in
+// order against the log itself, so the run stops at the same bad line
+// (and the same output) as with one thread
+static bool over_budget( const ErrorLog& errors, const ErrorLog& chunk )
+{
+  return errors.budget >= 0 && errors.lines + chunk.lines > errors.budget;
+}
+
+int tokenize_parallel( const char* begin, const char* end, int threads,
+                       size_t chunkSize, int& line, ErrorLog* errors, FILE* out )
+{
+  struct Output
+  {
+    std::string text;
+    bool        error;   // text ends with an unknown token
+    ErrorLog    log;     // --resync: bad lines of the chunk
+  };
+  std::vector<Output> outputs(chunk_slots(threads));
+
+  bool finished = for_each_chunk(begin, end, threads, chunkSize, line,
+    [&](const ChunkRange& c) {
+      Output& o = outputs[c.slot];
+      ScanToken tok;
+      o.text.clear();
+      o.error = false;
+      if (errors) {
+        start_chunk_log(o.log, *errors);
+        ResyncScanner scanner(c.begin, c.end, c.firstLine, o.log);
+        while (scanner.next(tok) != EOF_TOKEN && tok.code != UNKNOWN_TOKEN)
+          append_token(o.text, tok);
+        return;
+      }
+      FastScanner scanner(c.begin, c.end, c.firstLine);
+      while (scanner.next(tok) != EOF_TOKEN) {
+        append_token(o.text, tok);
+        if (tok.code == UNKNOWN_TOKEN) {
+          o.text += "ERROR: unknown token\n";
+          o.error = true;
+          break;
+        }
+      }
+    },
+    [&](const ChunkRange& c) {
+      Output& o = outputs[c.slot];
+      if (errors && over_budget(*errors, o.log)) {
+        ResyncScanner scanner(c.begin, c.end, c.firstLine, *errors);
+        ScanToken tok;
+        o.text.clear();
+        while (scanner.next(tok) != EOF_TOKEN && tok.code != UNKNOWN_TOKEN)
+          append_token(o.text, tok);
+        fwrite(o.text.data(), 1, o.text.size(), out);
+        return false;
+      }
+      if (errors) errors->merge(o.log);
+      fwrite(o.text.data(), 1, o.text.size(), out);
+      return !o.error;
+    });
+
+  return finished ? 0 : (-2);
+}
+
+int tally_parallel( const char* begin, const char* end, int threads,
+                    size_t chunkSize, int& line, ErrorLog* errors,
+                    Tally& tally, ScanToken& unknown )
+{
+  struct Counts
+  {
+    Tally     tally;
+    bool      error;
+    ScanToken unknown;
+    ErrorLog  log;
+  };
+  std::vector<Counts> counts(chunk_slots(threads));
+
+  bool finished = for_each_chunk(begin, end, threads, chunkSize, line,
+    [&](const ChunkRange& c) {
+      Counts& k = counts[c.slot];
+      k.tally = Tally(tally.histColumn);
+      k.error = false;
+      ScanToken tok;
+      if (errors) {
+        start_chunk_log(k.log, *errors);
+        ResyncScanner scanner(c.begin, c.end, c.firstLine, k.log);
+        while (scanner.next(tok) != EOF_TOKEN && tok.code != UNKNOWN_TOKEN)
+          k.tally.add(tok.code, tok.line);
+        return;
+      }
+      FastScanner scanner(c.begin, c.end, c.firstLine);
+      while (scanner.next(tok) != EOF_TOKEN) {
+        if (tok.code == UNKNOWN_TOKEN) {
+          k.error = true;
+          k.unknown = tok;
+          break;
+        }
+        k.tally.add(tok.code, tok.line);
+      }
+    },
+    [&](const ChunkRange& c) {
+      Counts& k = counts[c.slot];
+      if (errors && over_budget(*errors, k.log)) {
+        ResyncScanner scanner(c.begin, c.end, c.firstLine, *errors);
+        while (scanner.next(unknown) != EOF_TOKEN && unknown.code != UNKNOWN_TOKEN)
+          tally.add(unknown.code, unknown.line);
+        return false;
+      }
+      if (errors) errors->merge(k.log);
+      tally.merge(k.tally);
+      if (k.error) unknown = k.unknown;
+      return !k.error;
+    });
+
+  return finished ? 0 : (-2);
+}
+
+int query_parallel( const char* begin, const char* end, int threads,
+                    size_t chunkSize, int& line, const Query& query,
+                    ErrorLog* errors, QueryCounts& counts, FILE* rows )
+{
+  struct Result
+  {
+    QueryCounts counts;
+    std::string rows;
+    ErrorLog    log;
+  };
+  std::vector<Result> results(chunk_slots(threads));
+
+  bool finished = for_each_chunk(begin, end, threads, chunkSize, line,
+    [&](const ChunkRange& c) {
+      Result& r = results[c.slot];
+      int first = c.firstLine;
+      r.counts.rows = r.counts.matched = 0;
+      r.rows.clear();
+      if (errors) start_chunk_log(r.log, *errors);
+      query.run(c.begin, c.end, first, r.counts, rows ? &r.rows : NULL,
+                errors ? &r.log : NULL);
+    },
+    [&](const ChunkRange& c) {
+      Result& r = results[c.slot];
+      if (errors && over_budget(*errors, r.log)) {
+        int first = c.firstLine;
+        r.rows.clear();
+        query.run(c.begin, c.end, first, counts, rows ? &r.rows : NULL, errors);
+        if (rows) fwrite(r.rows.data(), 1, r.rows.size(), rows);
+        return false;
+      }
+      if (errors) errors->merge(r.log);
+      counts.rows += r.counts.rows;
+      counts.matched += r.counts.matched;
+      if (rows) fwrite(r.rows.data(), 1, r.rows.size(), rows);
+      return true;
+    });
+
+  return finished ? 0 : (-2);
+}
+
+int records_parallel( const char* begin, const char* end, int threads,
+                      size_t chunkSize, int& line, ErrorLog* errors,
+                      RecordColumns& out, RecordStats& stats )
+{
+  struct Part
+  {
+    RecordColumns columns;
+    RecordStats   stats;
+    ErrorLog      log;
+  };
+  std::vector<Part> parts(chunk_slots(threads));
+
+  bool finished = for_each_chunk(begin, end, threads, chunkSize, line,
+    [&](const ChunkRange& c) {
+      Part& p = parts[c.slot];
+      p.columns.clear();
+      RecordBuilder builder(p.columns);
+      ScanToken tok;
+      if (errors) {
+        start_chunk_log(p.log, *errors);
+        ResyncScanner scanner(c.begin, c.end, c.firstLine, p.log);
+        while (scanner.next(tok) != EOF_TOKEN && tok.code != UNKNOWN_TOKEN)
+          builder.add(tok);
+      }
+      else {
+        FastScanner scanner(c.begin, c.end, c.firstLine);
+        while (scanner.next(tok) != EOF_TOKEN)
+          builder.add(tok);
+      }
+      builder.finish();
+      p.stats.rejected = builder.rejected();
+      p.stats.firstRejectedLine = builder.firstRejectedLine();
+      p.stats.badDates = builder.badDates();
+    },
+    [&](const ChunkRange& c) {
+      Part& p = parts[c.slot];
+      if (errors && over_budget(*errors, p.log)) {
+        // only to stop on the same bad line as one thread: no rows are kept
+        ResyncScanner scanner(c.begin, c.end, c.firstLine, *errors);
+        ScanToken tok;
+        while (scanner.next(tok) != EOF_TOKEN && tok.code != UNKNOWN_TOKEN) {}
+        return false;
+      }
+      if (errors) errors->merge(p.log);
+      out.append(p.columns);
+      if (p.stats.rejected && !stats.rejected)
+        stats.firstRejectedLine = p.stats.firstRejectedLine;
+      stats.rejected += p.stats.rejected;
+      stats.badDates += p.stats.badDates;
+      return true;
+    });
+
+  return finished ? 0 : (-2);
+}
@@ -0,0 +1,233 @@
+//*****************************************************************************
+// purpose: multi-threaded tokenization for Lab 1 (lex --threads=N)
+// version: Fall 2024
+//
+// The input is cut into newline-aligned chunks. No rule in exp-rules.l
+// matches a '\n', so every newline is a token boundary, even inside a
+// quoted field like "White, Non-Hispanic". Each chunk therefore scans
+// exactly as it would in one pass.
+//
+// for_each_chunk() handles the chunks in rounds of one per thread, on one
+// pool of threads that lives for the whole call:
+//   1. the pool counts the newlines in each chunk of a round,
+//   2. a prefix sum over those counts gives each chunk its first line,
+//   3. the pool runs `work` on the chunks,
+//   4. the calling thread hands them to `done` in input order (which may
+//      stop the run).
+// Two rounds are in flight: while `done` takes one round, the pool
+// already scans the next, and the newlines of the one after are counted
+// as soon as its chunks are free. The calling thread helps the pool
+// whenever it waits, so no more than `threads` threads are busy at once.
+// Per-chunk results live in a caller array indexed by the chunk's slot,
+// so memory is bounded by two rounds whatever the file size. (Two rounds
+// of two chunks per thread were up to 15% slower on one core: that many
+// per-chunk output buffers no longer stay in cache.) This has only been
+// timed on a one-core machine; how it scales with cores is not measured.
+//*****************************************************************************
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "fastscan.h"
+#include "query.h"
+#include "resync.h"
+#include "tally.h"
+
+// Default chunk size for --threads
+const size_t kDefaultChunkSize = 1 << 20;
+
+struct ChunkRange
+{
+  const char* begin;
+  const char* end;
+  long        newlines;
+  int         firstLine;
+  size_t      slot;       // index in the caller's array, [0, chunk_slots())
+};
+
+// Slots needed in the caller's per-chunk array: two rounds of one chunk
+// per thread
+inline size_t chunk_slots( int threads ) { return 2 * (threads < 1 ? 1 : threads); }
+
+// Newlines in [begin, end)
+inline long count_newlines( const char* begin, const char* end )
+{
+  long k = 0;
+  for (const char* q = begin; (q = (const char*)memchr(q, '\n', end - q)) != NULL; q++)
+    k++;
+  return k;
+}
+
+// See the top of this file. work(const ChunkRange&) runs on any thread;
+// done(const ChunkRange&) runs in input order on the calling thread and
+// returns false to stop. `line` is the line number of `begin` and is
+// advanced past the chunks that were handled (so a source read in buffers
+// can be processed buffer by buffer). Returns false when `done` stopped
+// the run.
+template <class Work, class Done>
+bool for_each_chunk( const char* begin, const char* end, int threads,
+                     size_t chunkSize, int& line, Work work, Done done )
+{
+  if (threads < 1) threads = 1;
+  if (chunkSize < 1) chunkSize = 1;
+  if (begin >= end) return true;
+
+  // the chunks of round half h are chunks[h * per, h * per + count[h])
+  std::vector<ChunkRange> chunks(chunk_slots(threads));
+  const size_t per = chunks.size() / 2;
+  size_t count[2] = { 0, 0 };
+  int lineAfter[2] = { line, line };
+  int next = line;
+  const char* p = begin;
+
+  struct Task { size_t slot; int half; bool newlines; };
+  std::mutex m;
+  std::condition_variable ready, finished;
+  std::deque<Task> tasks;
+  size_t pending[2] = { 0, 0 };   // tasks of each half not yet finished
+  bool quit = false;
+
+  auto run = [&](const Task& t) {
+    ChunkRange& c = chunks[t.slot];
+    if (t.newlines) c.newlines = count_newlines(c.begin, c.end);
+    else work(c);
+  };
+  auto finish = [&](const Task& t) {   // with m held
+    if (!--pending[t.half]) finished.notify_all();
+  };
+  auto submit = [&](int h, bool newlines) {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      for (size_t k = 0; k < count[h]; k++)
+        tasks.push_back(Task{ h * per + k, h, newlines });
+      pending[h] += count[h];
+    }
+    ready.notify_all();
+  };
+  // wait for the tasks of half h, running queued tasks meanwhile
+  auto wait = [&](int h) {
+    std::unique_lock<std::mutex> lock(m);
+    while (pending[h]) {
+      if (tasks.empty()) {
+        finished.wait(lock);
+        continue;
+      }
+      Task t = tasks.front();
+      tasks.pop_front();
+      lock.unlock();
+      run(t);
+      lock.lock();
+      finish(t);
+    }
+  };
+  // cut the next round into half h, each chunk ending just after a newline
+  auto cut = [&](int h) {
+    size_t n = 0;
+    while (n < per && p < end) {
+      ChunkRange& c = chunks[h * per + n];
+      c.slot = h * per + n++;
+      c.begin = p;
+      const char* last = p + (chunkSize < (size_t)(end - p) ? chunkSize : end - p) - 1;
+      const char* nl = (const char*)memchr(last, '\n', end - last);
+      c.end = nl ? nl + 1 : end;
+      p = c.end;
+    }
+    count[h] = n;
+    if (n) submit(h, true);
+  };
+  auto number = [&](int h) {
+    for (size_t k = 0; k < count[h]; k++) {
+      chunks[h * per + k].firstLine = next;
+      next += chunks[h * per + k].newlines;
+    }
+    lineAfter[h] = next;
+  };
+
+  std::vector<std::thread> pool;
+  for (int i = 1; i < threads; i++)
+    pool.emplace_back([&]() {
+      std::unique_lock<std::mutex> lock(m);
+      for (;;) {
+        ready.wait(lock, [&]() { return !tasks.empty() || quit; });
+        if (tasks.empty()) return;
+        Task t = tasks.front();
+        tasks.pop_front();
+        lock.unlock();
+        run(t);
+        lock.lock();
+        finish(t);
+      }
+    });
+
+  cut(0);
+  wait(0);
+  number(0);
+  submit(0, false);
+  cut(1);
+
+  bool ok = true;
+  for (int h = 0; ok && count[h]; h = 1 - h) {
+    int o = 1 - h;
+    wait(h);
+    if (count[o]) {        // start scanning the next round before `done`
+      wait(o);
+      number(o);
+      submit(o, false);
+    }
+    line = lineAfter[h];
+    for (size_t k = 0; ok && k < count[h]; k++)
+      ok = done(chunks[h * per + k]);
+    if (ok) cut(h);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m);
+    tasks.clear();           // after a stop: the next round is not needed
+    quit = true;
+  }
+  ready.notify_all();
+  for (size_t i = 0; i < pool.size(); i++)
+    pool[i].join();
+  return ok;
+}
+
+// Tokenize [begin, end), which starts on `line`, on `threads` threads and
+// write the driver's per-token output to `out`. Returns 0, or -2 after the
+// first unknown token (as the driver does: output stops after
+// "ERROR: unknown token"). With `errors` (--resync) lines with unknown
+// tokens are dropped into the log instead, and -2 means the log ran over
+// its budget; the output then stops where one thread would stop.
+int tokenize_parallel( const char* begin, const char* end, int threads,
+                       size_t chunkSize, int& line, ErrorLog* errors, FILE* out );
+
+// Count the tokens of [begin, end) into `tally` on `threads` threads.
+// Returns 0, or -2 with the first unknown token in `unknown` (the tally
+// then holds the tokens before it). `errors` as for tokenize_parallel.
+int tally_parallel( const char* begin, const char* end, int threads,
+                    size_t chunkSize, int& line, ErrorLog* errors,
+                    Tally& tally, ScanToken& unknown );
+
+// Filter the rows of [begin, end) with `query` on `threads` threads. Adds
+// to `counts` and writes the matching rows, in input order, to `rows`
+// unless it is NULL. Returns 0, or with `errors` -2 when the log ran over
+// its budget (as for tokenize_parallel).
+int query_parallel( const char* begin, const char* end, int threads,
+                    size_t chunkSize, int& line, const Query& query,
+                    ErrorLog* errors, QueryCounts& counts, FILE* rows );
+
+// Build the records (records.h) of [begin, end) on `threads` threads and
+// append them to `out` in input order; the rejected rows are added to
+// `stats`. Returns 0, or with `errors` -2 when the log ran over its budget
+// (as for tokenize_parallel).
+int records_parallel( const char* begin, const char* end, int threads,
+                      size_t chunkSize, int& line, ErrorLog* errors,
+                      RecordColumns& out, RecordStats& stats );
+
+#endif
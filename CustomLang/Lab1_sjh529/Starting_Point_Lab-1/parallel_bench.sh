@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+# Lab 1 parallel tokenizer benchmark — makes a large CSV by repeating
+# sample.csv and times `lex --threads=N` (full output to /dev/null) for
+# N = 1, 2, 4, ... up to MAX_THREADS. A second, untimed run per N checks
+# that the output never changes.
+#
+# Usage: ./parallel_bench.sh [MEGABYTES] [MAX_THREADS]
+
+set -euo pipefail
+
+MB="${1:-256}"
+MAX="${2:-$(nproc)}"
+
+make -s lex
+
+TMP="$(mktemp -d)"; trap 'rm -rf "$TMP"' EXIT
+BIG="$TMP/big.csv"
+cp sample.csv "$BIG"
+while (( $(stat -c %s "$BIG") < MB * 1024 * 1024 )); do
+  cat "$BIG" "$BIG" > "$TMP/next.csv" && mv "$TMP/next.csv" "$BIG"
+done
+SIZE=$(stat -c %s "$BIG")
+
+echo "input: $SIZE bytes, $(nproc) cores"
+ref=""
+for ((n = 1; n <= MAX; n *= 2)); do
+  start=$(date +%s.%N)
+  ./lex --threads=$n "$BIG" > /dev/null
+  end=$(date +%s.%N)
+  sum=$(./lex --threads=$n "$BIG" | md5sum)
+  [[ -z "$ref" ]] && ref="$sum"
+  [[ "$sum" == "$ref" ]] || { echo "output differs at $n threads"; exit 1; }
+  awk -v n="$n" -v s="$start" -v e="$end" -v b="$SIZE" \
+    'BEGIN { printf "  %2d threads  %7.3f s  %6.3f GB/s\n", n, e - s, b / (e - s) / 1e9 }'
+done
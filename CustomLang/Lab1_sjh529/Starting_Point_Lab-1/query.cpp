@@ -0,0 +1,315 @@
+//*****************************************************************************
+// purpose: row filters for Lab 1 - see query.h
+// version: Fall 2024
+//*****************************************************************************
+#include "query.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+#include "dates.h"
+#include "resync.h"
+#include "tally.h"
+#include "tokens.h"
+
+namespace
+{
+
+// Words of a query: names, values, dates, 'quoted text' and operators
+class QueryLexer
+{
+public:
+  explicit QueryLexer( const char* text ) : p_(text) {}
+
+  // Next word, "" at the end; false on an unterminated quote
+  bool next( std::string& word )
+  {
+    word.clear();
+    while (isspace((unsigned char)*p_)) p_++;
+    if (!*p_) return true;
+    if (*p_ == '\'') {
+      const char* q = strchr(p_ + 1, '\'');
+      if (!q) return false;
+      word.assign(p_ + 1, q);
+      word.insert(0, 1, '\'');   // mark it as quoted (never an operator)
+      p_ = q + 1;
+      return true;
+    }
+    if (strchr("=!<>|", *p_)) {
+      word += *p_++;
+      if (*p_ == '=' && word != "|") word += *p_++;
+      return true;
+    }
+    while (*p_ && !isspace((unsigned char)*p_) && !strchr("=!<>|'", *p_))
+      word += *p_++;
+    return true;
+  }
+
+private:
+  const char* p_;
+};
+
+// Token code of `value` in column `col`: a token name, else the token the
+// scanner makes of the whole text; -1 if neither fits the column
+int value_code( int col, const std::string& value )
+{
+  bool quoted = !value.empty() && value[0] == '\'';
+  const char* text = value.c_str() + quoted;
+  if (!quoted)
+    for (int c = 0; c < kMaxTokenCode; c++)
+      if (strcasecmp(text, token_name(c)) == 0 && column_accepts(col, c))
+        return c;
+
+  // pad so the scanner may read a little past the text
+  std::string padded = std::string(text) + "\n" + std::string(64, '\0');
+  FastScanner scanner(padded.data(), padded.data() + strlen(text));
+  ScanToken tok, rest;
+  if (scanner.next(tok) == EOF_TOKEN || scanner.next(rest) != EOF_TOKEN)
+    return -1;
+  return column_accepts(col, tok.code) && tok.code != DATE ? tok.code : -1;
+}
+
+int32_t date_value( const std::string& value )
+{
+  if (value.size() != 10) return kBadDate;
+  return parse_date(value.c_str());
+}
+
+} // namespace
+
+Query::Query()
+  : lastField_(-1)
+{
+  memset(tested_, 0, sizeof tested_);
+  memset(codes_, 0, sizeof codes_);
+  for (int c = 0; c < kDateColumns; c++) {
+    from_[c] = INT32_MIN;
+    to_[c] = INT32_MAX;
+  }
+}
+
+bool Query::compile( const char* text, std::string& error )
+{
+  QueryLexer lexer(text);
+  std::string word, op;
+  bool more = true;
+
+  while (more) {
+    if (!lexer.next(word)) { error = "unterminated quote"; return false; }
+    int col = find_column(word.c_str());
+    if (col < 0) {
+      error = word.empty() ? "missing column" : "unknown column " + word;
+      return false;
+    }
+    lexer.next(op);
+
+    if (col < kDateColumns) {
+      // date: op DATE, or between DATE and DATE
+      int32_t lo = INT32_MIN, hi = INT32_MAX;
+      std::string a, b, word2;
+      lexer.next(a);
+      int32_t d = date_value(a);
+      if (strcasecmp(op.c_str(), "between") == 0) {
+        lexer.next(word2);
+        lexer.next(b);
+        int32_t e = date_value(b);
+        if (strcasecmp(word2.c_str(), "and") != 0 || d == kBadDate || e == kBadDate) {
+          error = "expected: " + word + " between YYYY/MM/DD and YYYY/MM/DD";
+          return false;
+        }
+        lo = d, hi = e;
+      }
+      else if (d == kBadDate) {
+        error = "not a date: " + (a.empty() ? op : a);
+        return false;
+      }
+      else if (op == "=")  lo = hi = d;
+      else if (op == "<")  hi = d - 1;
+      else if (op == "<=") hi = d;
+      else if (op == ">")  lo = d + 1;
+      else if (op == ">=") lo = d;
+      else if (op == "!=") {
+        error = "!= is not supported for dates (use < or >)";
+        return false;
+      }
+      else {
+        error = "expected = != < <= > >= or between after " + word;
+        return false;
+      }
+      tested_[col] = true;
+      if (lo > from_[col]) from_[col] = lo;
+      if (hi < to_[col]) to_[col] = hi;
+      lexer.next(word);
+    }
+    else {
+      // token: = VALUE|VALUE..., or != VALUE|VALUE...
+      if (op != "=" && op != "!=") {
+        error = "expected = or != after " + word;
+        return false;
+      }
+      uint64_t set[2] = { 0, 0 };
+      do {
+        lexer.next(word);
+        int code = value_code(col, word);
+        if (code < 0) {
+          error = "no value " + (word.empty() ? std::string("(empty)") : word) +
+                  " in column " + column_name(col);
+          return false;
+        }
+        set[code >> 6] |= 1ull << (code & 63);
+        lexer.next(word);
+      } while (word == "|");
+
+      if (op == "!=")
+        for (int c = 0; c < kMaxTokenCode; c++)
+          if (column_accepts(col, c)) set[c >> 6] ^= 1ull << (c & 63);
+      if (!tested_[col]) {
+        tested_[col] = true;
+        codes_[col][0] = codes_[col][1] = ~0ull;
+      }
+      codes_[col][0] &= set[0];
+      codes_[col][1] &= set[1];
+    }
+
+    if (col > lastField_) lastField_ = col;
+    more = strcasecmp(word.c_str(), "and") == 0;
+    if (!more && !word.empty()) {
+      error = "expected 'and' before " + word;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Query::test( int field, const ScanToken& tok ) const
+{
+  if (field < kDateColumns) {
+    if (tok.code != DATE) return false;
+    int32_t d = parse_date(tok.text);
+    return d != kBadDate && d >= from_[field] && d <= to_[field];
+  }
+  unsigned code = (unsigned)tok.code;
+  return code < 128 && (codes_[field][code >> 6] >> (code & 63) & 1);
+}
+
+// The rows of the tokens `scanner` returns; FastScanner, or with `resync`
+// ResyncScanner (whose only UNKNOWN_TOKEN ends the run)
+template <class Scanner>
+void Query::scan( Scanner& scanner, bool resync, const char* begin, const char* end,
+                  QueryCounts& counts, std::string* rows ) const
+{
+  ScanToken tok;
+  const char* rowStart = NULL;   // row being checked, NULL between rows
+  int rowLine = 0;
+  int field = 0;
+  bool filled = false;
+
+  // a matching row: [rowStart, rowEnd) plus a newline if the input has none
+  auto accept = [&]( const char* rowEnd ) {
+    counts.matched++;
+    if (rows) {
+      rows->append(rowStart, rowEnd);
+      if (rowEnd == rowStart || rowEnd[-1] != '\n') *rows += '\n';
+    }
+    rowStart = NULL;
+  };
+
+  for (;;) {
+    int code = scanner.next(tok);
+    if (rowStart && (code == EOF_TOKEN || tok.line != rowLine)) {
+      // the row ended inside its last tested field
+      if (field == lastField_ && filled) {
+        const char* nl = (const char*)memchr(rowStart, '\n', end - rowStart);
+        accept(nl ? nl + 1 : end);
+      }
+      rowStart = NULL;
+    }
+    if (code == EOF_TOKEN) break;
+    if (code == UNKNOWN_TOKEN && resync)
+      break;   // over the --max-errors budget
+
+    if (!rowStart) {
+      counts.rows++;
+      rowStart = tok.text;
+      while (rowStart > begin && rowStart[-1] != '\n') rowStart--;
+      rowLine = tok.line;
+      field = 0;
+      filled = false;
+    }
+
+    if (code == SEPARATOR) {
+      bool pass = !tested_[field] || filled;
+      if (pass && field == lastField_) {
+        scanner.skipLine();
+        accept(scanner.position());
+      }
+      else if (!pass) {
+        scanner.skipLine();
+        rowStart = NULL;
+      }
+      field++;
+      filled = false;
+      continue;
+    }
+    if (!tested_[field]) continue;
+    if (filled || !test(field, tok)) {
+      scanner.skipLine();
+      rowStart = NULL;
+      continue;
+    }
+    filled = true;
+  }
+}
+
+void Query::run( const char* begin, const char* end, int& line,
+                 QueryCounts& counts, std::string* rows, ErrorLog* errors ) const
+{
+  if (errors) {
+    ResyncScanner scanner(begin, end, line, *errors);
+    scan(scanner, true, begin, end, counts, rows);
+    line = scanner.line();
+  }
+  else {
+    FastScanner scanner(begin, end, line);
+    scan(scanner, false, begin, end, counts, rows);
+    line = scanner.line();
+  }
+}
+
+bool Query::mayMatch( const int32_t* min, const int32_t* max ) const
+{
+  for (int c = 0; c < kDateColumns; c++)
+    if (tested_[c] && (min[c] > max[c] || max[c] < from_[c] || min[c] > to_[c]))
+      return false;
+  return true;
+}
+
+void Query::runColumns( const ColumnsView& cols, size_t first, size_t last,
+                        QueryCounts& counts ) const
+{
+  uint8_t keep[4096];   // 1 while the row may still match
+  counts.rows += last - first;
+  for (size_t at = first; at < last; at += sizeof keep) {
+    size_t n = last - at < sizeof keep ? last - at : sizeof keep;
+    memset(keep, 1, n);
+    for (int c = 0; c <= lastField_; c++) {
+      if (!tested_[c]) continue;
+      if (c < kDateColumns) {
+        const int32_t* day = cols.date[c] + at;
+        int32_t lo = from_[c], hi = to_[c];
+        for (size_t i = 0; i < n; i++)
+          keep[i] &= day[i] != kNoDate && day[i] >= lo && day[i] <= hi;
+      }
+      else {
+        const uint8_t* code = cols.code[c - kDateColumns] + at;
+        const uint64_t* set = codes_[c];
+        for (size_t i = 0; i < n; i++)
+          keep[i] &= code[i] != kNoCode && (set[code[i] >> 6 & 1] >> (code[i] & 63) & 1);
+      }
+    }
+    long matched = 0;
+    for (size_t i = 0; i < n; i++)
+      matched += keep[i];
+    counts.matched += matched;
+  }
+}
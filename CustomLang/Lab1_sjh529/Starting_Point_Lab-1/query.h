@@ -0,0 +1,80 @@
+//*****************************************************************************
+// purpose: row filters for Lab 1 (lex --where 'QUERY' [--count])
+// version: Fall 2024
+//
+// A query is a list of tests joined by "and":
+//   status=LABORATORY and gender=FEMALE and age=AGE_1X|AGE_2X
+//   hosp!=YES and case_date between 2020/03/01 and 2020/06/30
+//   report_date>=2020/11/01
+// Columns are named as for --histogram (records.h). A value is a token name
+// (FEMALE) or a lexeme of the column ('10 - 19 Years', female); "|" lists
+// alternatives. Dates compare as calendar days with = != < <= > >=.
+//
+// compile() turns the query into one check per column: a 128-bit set of
+// accepted token codes, or a range of days for a date column. run() applies
+// the checks to the token stream as it is scanned. A row is dropped at the
+// first field that fails, and a row is accepted as soon as the last tested
+// field passes; either way the rest of the line is skipped with a memchr
+// instead of being tokenized. No records are built.
+//
+// Only the tested fields are looked at. A tested field must hold exactly
+// one token that passes; an empty field fails every test (also !=).
+//
+// The same query runs over typed columns (lex --read-columns --where ...
+// --count): runColumns() tests one column at a time over a block of rows,
+// and mayMatch() tells from a block's zone map (colfile.h) whether any of
+// its rows can pass the date tests, so the other blocks are never read.
+// A column file holds only the rows that made valid records (records.h).
+//*****************************************************************************
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <stdint.h>
+#include <string>
+#include "records.h"
+
+struct ErrorLog;
+
+struct QueryCounts
+{
+  long rows;      // lines with at least one token
+  long matched;   // rows that passed every test
+};
+
+class Query
+{
+public:
+  Query();
+
+  // Parse `text`; false with a message in `error` if it is not a query
+  bool compile( const char* text, std::string& error );
+
+  // Filter [begin, end), which starts on `line` (advanced past the buffer).
+  // Adds to `counts`; the text of each matching row (with its newline) is
+  // appended to `rows` unless it is NULL. With `errors` (--resync, resync.h)
+  // lines with unknown tokens are dropped into the log, and the run stops
+  // where the log goes over its budget.
+  void run( const char* begin, const char* end, int& line,
+            QueryCounts& counts, std::string* rows, ErrorLog* errors ) const;
+
+  // Can a block whose date columns hold days min[c]..max[c] have a match?
+  bool mayMatch( const int32_t* min, const int32_t* max ) const;
+
+  // Count the rows [first, last) of `cols` that match
+  void runColumns( const ColumnsView& cols, size_t first, size_t last,
+                   QueryCounts& counts ) const;
+
+private:
+  bool test( int field, const ScanToken& tok ) const;
+  template <class Scanner>
+  void scan( Scanner& scanner, bool resync, const char* begin, const char* end,
+             QueryCounts& counts, std::string* rows ) const;
+
+  bool     tested_[COL_COUNT];
+  uint64_t codes_[COL_COUNT][2];       // accepted token codes, by column
+  int32_t  from_[kDateColumns];        // accepted days, by date column
+  int32_t  to_[kDateColumns];
+  int      lastField_;                 // highest tested column
+};
+
+#endif
@@ -0,0 +1,207 @@
+//*****************************************************************************
+// purpose: typed column store built from the Lab 1 token stream - see records.h
+// version: Fall 2024
+//*****************************************************************************
+#include "records.h"
+
+#include "dates.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char* const kColumnNames[COL_COUNT] = {
+  "cdc_case_earliest_dt", "cdc_report_dt", "pos_spec_dt", "onset_dt",
+  "current_status", "sex", "age_group", "race_ethnicity",
+  "hosp_yn", "icu_yn", "death_yn", "medcond_yn",
+};
+
+const char* column_name( int col )
+{
+  return col >= 0 && col < COL_COUNT ? kColumnNames[col] : "?";
+}
+
+int find_column( const char* name )
+{
+  static const struct { const char* alias; int col; } kAliases[] = {
+    { "case_date", COL_CASE_DATE }, { "report_date", COL_REPORT_DATE },
+    { "specimen_date", COL_SPECIMEN_DATE }, { "onset_date", COL_ONSET_DATE },
+    { "status", COL_STATUS }, { "sex", COL_SEX }, { "gender", COL_SEX },
+    { "age", COL_AGE }, { "ethnicity", COL_ETHNICITY }, { "race", COL_ETHNICITY },
+    { "hosp", COL_HOSP }, { "icu", COL_ICU }, { "death", COL_DEATH },
+    { "medcond", COL_MEDCOND },
+  };
+  for (int c = 0; c < COL_COUNT; c++)
+    if (strcmp(name, kColumnNames[c]) == 0) return c;
+  for (size_t i = 0; i < sizeof kAliases / sizeof kAliases[0]; i++)
+    if (strcmp(name, kAliases[i].alias) == 0) return kAliases[i].col;
+  char* end;
+  long n = strtol(name, &end, 10);
+  if (*name && !*end && n >= 1 && n <= COL_COUNT) return (int)n - 1;
+  return -1;
+}
+
+bool column_accepts( int col, int code )
+{
+  if (col < kDateColumns) return code == DATE;
+  if (code == UNKNOWN_VALUE || code == MISSING) return true;
+  switch (col)
+  {
+    case COL_STATUS:    return code == LABORATORY || code == PROBABLE;
+    case COL_SEX:       return code >= MALE && code <= OTHER;
+    case COL_AGE:       return code >= AGE_0X && code <= AGE_8X;
+    case COL_ETHNICITY: return code >= HISPANIC && code <= MULTIPLE_OTHER;
+    case COL_HOSP:
+    case COL_ICU:
+    case COL_DEATH:
+    case COL_MEDCOND:   return code == YES || code == NO;
+    default:            return false;
+  }
+}
+
+void RecordColumns::clear()
+{
+  for (int c = 0; c < kDateColumns; c++) date[c].clear();
+  for (int c = 0; c < COL_COUNT - kDateColumns; c++) code[c].clear();
+}
+
+void RecordColumns::append( const RecordColumns& other )
+{
+  for (int c = 0; c < kDateColumns; c++)
+    date[c].insert(date[c].end(), other.date[c].begin(), other.date[c].end());
+  for (int c = 0; c < COL_COUNT - kDateColumns; c++)
+    code[c].insert(code[c].end(), other.code[c].begin(), other.code[c].end());
+}
+
+ColumnsView RecordColumns::view() const
+{
+  ColumnsView v;
+  v.rows = rows();
+  for (int c = 0; c < kDateColumns; c++) v.date[c] = date[c].data();
+  for (int c = 0; c < COL_COUNT - kDateColumns; c++) v.code[c] = code[c].data();
+  return v;
+}
+
+// Rows whose dates one parse_dates() call decodes, at most
+static const size_t kBatchRows = 1024;
+
+RecordBuilder::RecordBuilder( RecordColumns& out )
+  : out_(out), line_(0), field_(0), bad_(false), filled_(false),
+    checked_(out.rows()), rejected_(0), badDates_(0), firstRejected_(0)
+{
+}
+
+void RecordBuilder::add( const ScanToken& tok )
+{
+  if (tok.code == EOF_TOKEN) {
+    finish();
+    return;
+  }
+  if (tok.line != line_) {
+    if (line_) endRow();
+    line_ = tok.line;
+    field_ = 0;
+    bad_ = false;
+    filled_ = false;
+    for (int c = 0; c < kDateColumns; c++) dateText_[c] = NULL;
+    for (int c = 0; c < COL_COUNT - kDateColumns; c++) codes_[c] = kNoCode;
+  }
+  if (bad_) return;
+
+  if (tok.code == SEPARATOR) {
+    field_++;
+    filled_ = false;
+    bad_ = field_ >= COL_COUNT;
+    return;
+  }
+  if (filled_ || !column_accepts(field_, tok.code)) {
+    bad_ = true;
+    return;
+  }
+  filled_ = true;
+  if (field_ < kDateColumns)
+    dateText_[field_] = tok.text;
+  else
+    codes_[field_ - kDateColumns] = (uint8_t)tok.code;
+}
+
+void RecordBuilder::finish()
+{
+  if (line_) endRow();
+  line_ = 0;
+  decodeDates();
+}
+
+void RecordBuilder::reject( int line )
+{
+  if (!rejected_++ || line < firstRejected_) firstRejected_ = line;
+}
+
+void RecordBuilder::endRow()
+{
+  if (bad_ || field_ != COL_COUNT - 1) {
+    reject(line_);
+    return;
+  }
+  // keep the row; its dates are filled in by decodeDates()
+  uint32_t row = (uint32_t)(out_.rows() - checked_);
+  for (int c = 0; c < kDateColumns; c++) {
+    out_.date[c].push_back(kNoDate);
+    if (dateText_[c]) {
+      dates_.push_back(dateText_[c]);
+      slots_.push_back(row * kDateColumns + c);
+    }
+  }
+  for (int c = 0; c < COL_COUNT - kDateColumns; c++) out_.code[c].push_back(codes_[c]);
+  lines_.push_back(line_);
+  if (lines_.size() >= kBatchRows) decodeDates();
+}
+
+// Decode the queued dates in one call, then close the gaps of the rows
+// that hold a bad one
+void RecordBuilder::decodeDates()
+{
+  size_t n = dates_.size();
+  days_.resize(n);
+  size_t bad = n ? parse_dates(dates_.data(), n, days_.data()) : 0;
+  for (size_t i = 0; i < n; i++)
+    out_.date[slots_[i] % kDateColumns][checked_ + slots_[i] / kDateColumns] = days_[i];
+
+  if (bad) {
+    size_t to = checked_;
+    for (size_t r = checked_; r < out_.rows(); r++) {
+      bool ok = true;
+      for (int c = 0; c < kDateColumns; c++)
+        ok &= out_.date[c][r] != kBadDate;
+      if (!ok) {
+        reject(lines_[r - checked_]);
+        badDates_++;
+        continue;
+      }
+      if (to != r) {
+        for (int c = 0; c < kDateColumns; c++) out_.date[c][to] = out_.date[c][r];
+        for (int c = 0; c < COL_COUNT - kDateColumns; c++) out_.code[c][to] = out_.code[c][r];
+      }
+      to++;
+    }
+    for (int c = 0; c < kDateColumns; c++) out_.date[c].resize(to);
+    for (int c = 0; c < COL_COUNT - kDateColumns; c++) out_.code[c].resize(to);
+  }
+  checked_ = out_.rows();
+  dates_.clear();
+  slots_.clear();
+  lines_.clear();
+}
+
+RecordStats build_records( const char* begin, const char* end, RecordColumns& out )
+{
+  FastScanner scanner(begin, end);
+  RecordBuilder builder(out);
+  ScanToken tok;
+  while (scanner.next(tok) != EOF_TOKEN)
+    builder.add(tok);
+  builder.finish();
+  RecordStats stats;
+  stats.rejected = builder.rejected();
+  stats.firstRejectedLine = builder.firstRejectedLine();
+  stats.badDates = builder.badDates();
+  return stats;
+}
@@ -0,0 +1,131 @@
+//*****************************************************************************
+// purpose: typed column store built from the Lab 1 token stream
+// version: Fall 2024
+//
+// RecordBuilder takes the tokens of one CSV row at a time and appends the
+// row to RecordColumns, one vector per column (struct of arrays):
+//   * the four date columns as int32 days since 1970-01-01 (the dates of
+//     many rows are decoded by one parse_dates() call, dates.h),
+//   * every other column as the uint8 token code from lexer.h.
+// An empty field is stored as kNoDate or kNoCode. That is 24 bytes per row.
+//
+// A row is kept only when it has exactly COL_COUNT fields, each field is
+// empty or one token of the column's kind, and every date is a real
+// calendar day. Other rows are counted as rejected and skipped. A row whose
+// fields fit is appended at once and its DATE lexemes are queued; finish()
+// (or a full queue) decodes the queue and drops the rows with a bad date,
+// so the lexemes must stay readable until then.
+//*****************************************************************************
+#ifndef RECORDS_H
+#define RECORDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "fastscan.h"
+
+// Columns of the case extract, in file order
+enum Column
+{
+  COL_CASE_DATE,      // cdc_case_earliest_dt
+  COL_REPORT_DATE,    // cdc_report_dt
+  COL_SPECIMEN_DATE,  // pos_spec_dt
+  COL_ONSET_DATE,     // onset_dt
+  COL_STATUS,         // current_status   LABORATORY / PROBABLE
+  COL_SEX,            // sex              MALE / FEMALE / OTHER
+  COL_AGE,            // age_group        AGE_0X .. AGE_8X
+  COL_ETHNICITY,      // race_ethnicity   HISPANIC .. MULTIPLE_OTHER
+  COL_HOSP,           // hosp_yn          YES / NO
+  COL_ICU,            // icu_yn
+  COL_DEATH,          // death_yn
+  COL_MEDCOND,        // medcond_yn
+  COL_COUNT
+};
+
+const int     kDateColumns = 4;          // columns [0, kDateColumns) hold dates
+const int32_t kNoDate      = INT32_MIN;  // empty date field
+const uint8_t kNoCode      = 0;          // empty categorical field
+
+// Column name as in the CDC extract ("cdc_case_earliest_dt", ...)
+const char* column_name( int col );
+
+// Column index for a CDC name ("age_group"), a short name ("age", "status",
+// "gender", ...) or a 1-based column number; -1 if none matches
+int find_column( const char* name );
+
+// Can `code` appear in column `col`? (UNKNOWN_VALUE and MISSING fit any
+// categorical column)
+bool column_accepts( int col, int code );
+
+// Read-only pointers to the columns, wherever they live (RecordColumns in
+// memory or a mapped column file, colfile.h)
+struct ColumnsView
+{
+  size_t         rows;
+  const int32_t* date[kDateColumns];
+  const uint8_t* code[COL_COUNT - kDateColumns];
+
+  size_t bytes() const { return rows * (kDateColumns * 4 + COL_COUNT - kDateColumns); }
+};
+
+struct RecordColumns
+{
+  std::vector<int32_t> date[kDateColumns];            // date[col]
+  std::vector<uint8_t> code[COL_COUNT - kDateColumns]; // code[col - kDateColumns]
+
+  size_t rows() const { return date[0].size(); }
+  size_t bytes() const { return rows() * (kDateColumns * 4 + COL_COUNT - kDateColumns); }
+
+  void clear();
+  void append( const RecordColumns& other );
+  ColumnsView view() const;
+};
+
+class RecordBuilder
+{
+public:
+  explicit RecordBuilder( RecordColumns& out );
+
+  // Feed every token of the input in order (EOF_TOKEN ends the last row).
+  // Call finish() before the buffer holding the tokens goes away; the
+  // counts below are exact only after it.
+  void add( const ScanToken& tok );
+  void finish();
+
+  long rejected() const { return rejected_; }
+  int  firstRejectedLine() const { return firstRejected_; }
+  long badDates() const { return badDates_; }   // rows rejected for a date
+
+private:
+  void endRow();
+  void decodeDates();
+  void reject( int line );
+
+  RecordColumns& out_;
+  int     line_;       // line of the row being built, 0 before the first
+  int     field_;      // index of the current field
+  bool    bad_;        // row already known to be rejected
+  bool    filled_;     // current field has a token
+  const char* dateText_[kDateColumns];   // DATE lexemes of the row, or NULL
+  uint8_t codes_[COL_COUNT - kDateColumns];
+  size_t  checked_;    // rows of out_ whose dates are decoded
+  std::vector<const char*> dates_;   // queued DATE lexemes
+  std::vector<uint32_t> slots_;      // their (row - checked_) * kDateColumns + col
+  std::vector<int>      lines_;      // line of each row from checked_ on
+  std::vector<int32_t>  days_;
+  long    rejected_;
+  long    badDates_;
+  int     firstRejected_;
+};
+
+struct RecordStats
+{
+  long rejected;            // rows skipped
+  int  firstRejectedLine;   // line of the first one
+  long badDates;            // rows skipped for an invalid calendar date
+};
+
+// Tokenize [begin, end) with FastScanner and build its records
+RecordStats build_records( const char* begin, const char* end, RecordColumns& out );
+
+#endif
@@ -0,0 +1,171 @@
+//*****************************************************************************
+// purpose: error resynchronization for Lab 1 - see resync.h
+// version: Fall 2024
+//*****************************************************************************
+#include "resync.h"
+
+#include <ctype.h>
+#include <string.h>
+
+const char* bad_kind_name( int kind )
+{
+  static const char* const kNames[BAD_KINDS] = {
+    "letter", "digit", "quote", "punctuation", "control", "non-ascii",
+  };
+  return kind >= 0 && kind < BAD_KINDS ? kNames[kind] : "?";
+}
+
+static int bad_kind( unsigned char c )
+{
+  if (c >= 0x80) return BAD_NONASCII;
+  if (isalpha(c)) return BAD_LETTER;
+  if (isdigit(c)) return BAD_DIGIT;
+  if (c == '"') return BAD_QUOTE;
+  if (isgraph(c)) return BAD_PUNCT;
+  return BAD_CONTROL;
+}
+
+ErrorLog::ErrorLog()
+  : lines(0), firstLine(0), lastLine(0), budget(-1), quarantine(NULL),
+    keepText(false)
+{
+  memset(byKind, 0, sizeof byKind);
+  memset(byColumn, 0, sizeof byColumn);
+}
+
+void ErrorLog::add( int line, const char* lineStart, const char* lineEnd,
+                    int column, unsigned char byte )
+{
+  if (!lines++) firstLine = line;
+  lastLine = line;
+  byKind[bad_kind(byte)]++;
+  byColumn[column < COL_COUNT ? column : COL_COUNT]++;
+
+  if (quarantine) {
+    fprintf(quarantine, "%d\t", line);
+    fwrite(lineStart, 1, lineEnd - lineStart, quarantine);
+    fputc('\n', quarantine);
+  }
+  else if (keepText) {
+    char number[16];
+    text.append(number, snprintf(number, sizeof number, "%d\t", line));
+    text.append(lineStart, lineEnd);
+    text += '\n';
+  }
+}
+
+void ErrorLog::merge( const ErrorLog& other )
+{
+  if (!other.lines) return;
+  if (!lines) firstLine = other.firstLine;
+  lastLine = other.lastLine;
+  lines += other.lines;
+  for (int k = 0; k < BAD_KINDS; k++) byKind[k] += other.byKind[k];
+  for (int c = 0; c <= COL_COUNT; c++) byColumn[c] += other.byColumn[c];
+  if (quarantine)
+    fwrite(other.text.data(), 1, other.text.size(), quarantine);
+  else if (keepText)
+    text += other.text;
+}
+
+ResyncScanner::ResyncScanner( const char* begin, const char* end, int firstLine,
+                              ErrorLog& log )
+  : scanner_(begin, end, firstLine), begin_(begin), end_(end), log_(log),
+    next_(0), haveAhead_(false), stopped_(false)
+{
+}
+
+// Collect the tokens of the next line without unknown tokens into
+// pending_; false at the end of the buffer or when over budget
+bool ResyncScanner::readLine()
+{
+  pending_.clear();
+  next_ = 0;
+  if (stopped_) return false;
+  for (;;) {
+    ScanToken tok;
+    if (haveAhead_) {
+      tok = ahead_;
+      haveAhead_ = false;
+    }
+    else if (scanner_.next(tok) == EOF_TOKEN)
+      return false;
+
+    int line = tok.line;
+    int field = 0;
+    bool bad = false;
+    for (;;) {
+      if (tok.code == UNKNOWN_TOKEN) {
+        const char* start = pending_.empty() ? tok.text : pending_[0].text;
+        while (start > begin_ && start[-1] != '\n') start--;
+        const char* stop = (const char*)memchr(tok.text, '\n', end_ - tok.text);
+        log_.add(line, start, stop ? stop : end_, field, (unsigned char)*tok.text);
+        if (log_.overBudget()) {
+          unknown_ = tok;
+          stopped_ = true;
+          return false;
+        }
+        scanner_.skipLine();
+        pending_.clear();
+        bad = true;
+        break;
+      }
+      if (tok.code == SEPARATOR) field++;
+      pending_.push_back(tok);
+
+      if (scanner_.next(tok) == EOF_TOKEN) break;
+      if (tok.line != line) {
+        ahead_ = tok;
+        haveAhead_ = true;
+        break;
+      }
+    }
+    if (!bad) return true;
+  }
+}
+
+const char* ResyncScanner::position() const
+{
+  if (pending_.empty()) return scanner_.position();
+  const ScanToken& last = pending_.back();
+  const char* nl = (const char*)memchr(last.text + last.length, '\n',
+                                       end_ - (last.text + last.length));
+  return nl ? nl + 1 : end_;
+}
+
+// next() at the end of the pending line
+int ResyncScanner::nextLine( ScanToken& tok )
+{
+  if (!readLine()) {
+    if (stopped_) {
+      tok = unknown_;
+      return UNKNOWN_TOKEN;
+    }
+    tok.code = EOF_TOKEN;
+    tok.text = end_;
+    tok.length = 0;
+    tok.line = scanner_.line();
+    return EOF_TOKEN;
+  }
+  tok = pending_[next_++];
+  return tok.code;
+}
+
+void print_errors( const ErrorLog& log, const char* quarantinePath, FILE* out )
+{
+  fprintf(out, "bad lines: %ld", log.lines);
+  if (log.lines) fprintf(out, "  (first on line %d)", log.firstLine);
+  if (quarantinePath) fprintf(out, "  quarantine: %s", quarantinePath);
+  fprintf(out, "\n");
+  if (!log.lines) return;
+
+  fprintf(out, "%-22s %12s\n", "first bad byte", "lines");
+  for (int k = 0; k < BAD_KINDS; k++)
+    if (log.byKind[k])
+      fprintf(out, "%-22s %12ld\n", bad_kind_name(k), log.byKind[k]);
+  fprintf(out, "%-22s %12s\n", "column", "lines");
+  for (int c = 0; c <= COL_COUNT; c++)
+    if (log.byColumn[c])
+      fprintf(out, "%-22s %12ld\n", c < COL_COUNT ? column_name(c) : "(extra field)",
+              log.byColumn[c]);
+}
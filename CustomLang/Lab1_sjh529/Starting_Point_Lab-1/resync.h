@@ -0,0 +1,105 @@
+//*****************************************************************************
+// purpose: error resynchronization for Lab 1 (lex --resync[=FILE])
+// version: Fall 2024
+//
+// The driver stops at the first UNKNOWN_TOKEN. With --resync a line that
+// holds an unknown token is dropped instead: none of its tokens are
+// printed or counted, the line number and the raw bytes of the line go to
+// the quarantine file, and scanning goes on at the next line (a newline is
+// always a record boundary, see parallel.h). Bad lines are counted by the
+// kind of the first byte the rules could not match and by the column it
+// was in. --max-errors=N gives up after N bad lines.
+//
+// Quarantine file: one line per bad line, "LINE<TAB>bytes of the line".
+//*****************************************************************************
+#ifndef RESYNC_H
+#define RESYNC_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "fastscan.h"
+#include "records.h"
+
+// What the first unmatched byte of a bad line looks like
+enum BadKind
+{
+  BAD_LETTER,      // a misspelled value: Femal, N/A
+  BAD_DIGIT,       // a broken number or date: 2020//02/01
+  BAD_QUOTE,       // a quoted value no rule spells: "Other"
+  BAD_PUNCT,       // any other printable byte: ? # ;
+  BAD_CONTROL,     // control bytes, NUL
+  BAD_NONASCII,    // bytes >= 0x80 (UTF-8, Latin-1)
+  BAD_KINDS
+};
+
+const char* bad_kind_name( int kind );
+
+struct ErrorLog
+{
+  long  lines;                      // bad lines
+  int   firstLine;                  // line of the first one
+  int   lastLine;                   // line of the latest one
+  long  byKind[BAD_KINDS];
+  long  byColumn[COL_COUNT + 1];    // [COL_COUNT]: past the last column
+  long  budget;                     // give up after this many; < 0: never
+  FILE* quarantine;                 // write bad lines here, or
+  bool  keepText;                   // keep them in `text` (for merge())
+  std::string text;
+
+  ErrorLog();
+
+  // Record a bad line [lineStart, lineEnd) whose first unknown byte is
+  // `byte`, found in field `column`
+  void add( int line, const char* lineStart, const char* lineEnd,
+            int column, unsigned char byte );
+
+  // Add the counts of a later part of the input (and write its text)
+  void merge( const ErrorLog& other );
+
+  bool overBudget() const { return budget >= 0 && lines > budget; }
+};
+
+// Tokens of the lines without unknown tokens, as FastScanner returns them.
+// UNKNOWN_TOKEN is returned only when the log runs over its budget (the
+// token is the one that did it).
+class ResyncScanner
+{
+public:
+  ResyncScanner( const char* begin, const char* end, int firstLine, ErrorLog& log );
+
+  int next( ScanToken& tok )
+  {
+    if (next_ < pending_.size()) {
+      tok = pending_[next_++];
+      return tok.code;
+    }
+    return nextLine(tok);
+  }
+  int line() const { return scanner_.line(); }
+
+  // As FastScanner's: drop the rest of the current line, and the end of
+  // that line (after its newline)
+  void skipLine() { next_ = pending_.size(); }
+  const char* position() const;
+
+private:
+  bool readLine();
+  int  nextLine( ScanToken& tok );
+
+  FastScanner            scanner_;
+  const char*            begin_;
+  const char*            end_;
+  ErrorLog&              log_;
+  std::vector<ScanToken> pending_;  // tokens of the current clean line
+  size_t                 next_;
+  ScanToken              ahead_;    // first token of the following line
+  bool                   haveAhead_;
+  ScanToken              unknown_;  // set when over budget
+  bool                   stopped_;
+};
+
+// "bad lines: N ..." and the counts per kind and per column
+void print_errors( const ErrorLog& log, const char* quarantinePath, FILE* out );
+
+#endif
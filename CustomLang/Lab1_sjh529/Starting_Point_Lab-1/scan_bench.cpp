@@ -0,0 +1,59 @@
+//*****************************************************************************
+// purpose: throughput benchmark for the Lab 1 SIMD scanning engine
+// version: Fall 2024
+//
+//   scan_bench file [runs]
+//
+// Scans the whole file `runs` times (default 5) with FastScanner, counting
+// tokens only, and prints the best time in GB/s. Set FASTSCAN_ISA to
+// compare the scalar, sse2 and avx2 block masks.
+//*****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lexer.h"
+#include "fastscan.h"
+#include "mapfile.h"
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main( int argc, char* argv[] )
+{
+  if (argc < 2) {
+    printf("usage: %s file [runs]\n", argv[0]);
+    return (-1);
+  }
+  int runs = argc > 2 ? atoi(argv[2]) : 5;
+
+  MappedFile in;
+  if (!in.open(argv[1])) {
+    printf("ERROR: input file not found\n");
+    return (-1);
+  }
+
+  double best = 0;
+  long tokens = 0, unknown = 0;
+  for (int r = 0; r < runs; r++) {
+    double t0 = seconds();
+    FastScanner scanner(in.data(), in.end());
+    ScanToken tok;
+    tokens = unknown = 0;
+    while (scanner.next(tok) != EOF_TOKEN) {
+      tokens++;
+      unknown += tok.code == UNKNOWN_TOKEN;
+    }
+    double t = seconds() - t0;
+    if (r == 0 || t < best) best = t;
+  }
+
+  printf("%s: %zu bytes, %ld tokens (%ld unknown), isa %s\n",
+      argv[1], in.size(), tokens, unknown, fastscan_isa());
+  printf("best of %d: %.3f s  %.2f GB/s  %.1f Mtokens/s\n",
+      runs, best, in.size() / best / 1e9, tokens / best / 1e6);
+  return 0;
+}
@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+# Lab 1 SIMD scanner benchmark — builds scan_bench, makes a large CSV by
+# repeating sample.csv, and reports GB/s for each block-mask implementation.
+#
+# Usage: ./simd_bench.sh [MEGABYTES] [RUNS]
+
+set -euo pipefail
+
+MB="${1:-512}"
+RUNS="${2:-5}"
+
+make -s scan_bench
+
+TMP="$(mktemp -d)"; trap 'rm -rf "$TMP"' EXIT
+BIG="$TMP/big.csv"
+cp sample.csv "$BIG"
+while (( $(stat -c %s "$BIG") < MB * 1024 * 1024 )); do
+  cat "$BIG" "$BIG" > "$TMP/next.csv" && mv "$TMP/next.csv" "$BIG"
+done
+
+for isa in scalar sse2 avx2; do
+  FASTSCAN_ISA=$isa ./scan_bench "$BIG" "$RUNS"
+done
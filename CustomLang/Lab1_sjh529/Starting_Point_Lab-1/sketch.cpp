@@ -0,0 +1,203 @@
+//*****************************************************************************
+// purpose: approximate analytics for Lab 1 - see sketch.h
+// version: Fall 2024
+//*****************************************************************************
+#include "sketch.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include "dedup.h"
+#include "fastscan.h"
+#include "parallel.h"
+#include "records.h"
+
+HyperLogLog::HyperLogLog()
+{
+  clear();
+}
+
+void HyperLogLog::clear()
+{
+  memset(registers_, 0, sizeof registers_);
+}
+
+void HyperLogLog::merge( const HyperLogLog& other )
+{
+  for (size_t i = 0; i < sizeof registers_; i++)
+    if (other.registers_[i] > registers_[i]) registers_[i] = other.registers_[i];
+}
+
+double HyperLogLog::estimate() const
+{
+  const double m = 1 << kBits;
+  double sum = 0;
+  int zeros = 0;
+  for (size_t i = 0; i < sizeof registers_; i++) {
+    sum += ldexp(1.0, -registers_[i]);
+    zeros += registers_[i] == 0;
+  }
+  double e = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+  if (e <= 2.5 * m && zeros)   // small range: linear counting
+    e = m * log(m / zeros);
+  return e;
+}
+
+double HyperLogLog::relativeError()
+{
+  return 1.04 / sqrt((double)(1 << kBits));
+}
+
+static bool by_priority( const SampledRow& a, const SampledRow& b )
+{
+  return a.priority < b.priority;
+}
+
+void RowSample::add( uint64_t priority, int line, const char* begin, const char* end )
+{
+  if (!wants(priority)) return;
+  if (heap_.size() == size_) {
+    std::pop_heap(heap_.begin(), heap_.end(), by_priority);
+    heap_.pop_back();
+  }
+  heap_.push_back(SampledRow());
+  SampledRow& row = heap_.back();
+  row.priority = priority;
+  row.line = line;
+  row.text.assign(begin, end);
+  if (row.text.empty() || row.text.back() != '\n') row.text += '\n';
+  std::push_heap(heap_.begin(), heap_.end(), by_priority);
+}
+
+void RowSample::merge( const RowSample& other )
+{
+  for (size_t i = 0; i < other.heap_.size(); i++) {
+    const SampledRow& r = other.heap_[i];
+    if (!wants(r.priority)) continue;
+    if (heap_.size() == size_) {
+      std::pop_heap(heap_.begin(), heap_.end(), by_priority);
+      heap_.pop_back();
+    }
+    heap_.push_back(r);
+    std::push_heap(heap_.begin(), heap_.end(), by_priority);
+  }
+}
+
+void RowSample::rows( std::vector<SampledRow>& out ) const
+{
+  out = heap_;
+  std::sort(out.begin(), out.end(),
+            []( const SampledRow& a, const SampledRow& b ) { return a.line < b.line; });
+}
+
+Sketches::Sketches( const SketchSpec& spec )
+  : rows(0), distinct(spec.keys.size()), sample(spec.sample)
+{
+}
+
+void Sketches::clear()
+{
+  rows = 0;
+  for (size_t k = 0; k < distinct.size(); k++) distinct[k].clear();
+  sample.clear();
+}
+
+void Sketches::merge( const Sketches& other )
+{
+  rows += other.rows;
+  for (size_t k = 0; k < distinct.size(); k++) distinct[k].merge(other.distinct[k]);
+  sample.merge(other.sample);
+}
+
+bool parse_sketch_key( const char* text, uint32_t& key )
+{
+  if (strcmp(text, "row") == 0) {
+    key = kRowKey;
+    return true;
+  }
+  key = 0;
+  std::string list(text);
+  size_t at = 0;
+  do {
+    size_t comma = list.find(',', at);
+    std::string name = list.substr(at, comma == std::string::npos ? std::string::npos : comma - at);
+    int col = find_column(name.c_str());
+    if (col < 0) return false;
+    key |= 1u << col;
+    at = comma == std::string::npos ? comma : comma + 1;
+  } while (at != std::string::npos);
+  return key != 0;
+}
+
+void sketch_rows( const char* begin, const char* end, int firstLine,
+                  const SketchSpec& spec, Sketches& out )
+{
+  FastScanner scanner(begin, end, firstLine);
+  ScanToken tok;
+  const char* rowStart = NULL;   // row being sketched, NULL between rows
+  int line = 0;
+  int field = 0;
+  uint64_t row = 0;
+  uint64_t fields[COL_COUNT];    // hash of each field's tokens
+
+  auto close = [&]() {
+    out.rows++;
+    for (size_t k = 0; k < spec.keys.size(); k++) {
+      uint64_t h = row;
+      if (spec.keys[k] != kRowKey) {
+        h = kHashSeed;
+        for (int c = 0; c < COL_COUNT; c++)
+          if (spec.keys[k] >> c & 1) h = hash_mix(h, fields[c]);
+      }
+      out.distinct[k].add(hash_finish(h));
+    }
+    if (spec.sample) {
+      uint64_t priority = hash_finish((uint64_t)line * 0x9E3779B97F4A7C15ull ^ spec.seed);
+      if (out.sample.wants(priority)) {
+        const char* nl = (const char*)memchr(rowStart, '\n', end - rowStart);
+        out.sample.add(priority, line, rowStart, nl ? nl + 1 : end);
+      }
+    }
+  };
+
+  for (;;) {
+    int code = scanner.next(tok);
+    if (rowStart && (code == EOF_TOKEN || tok.line != line)) {
+      close();
+      rowStart = NULL;
+    }
+    if (code == EOF_TOKEN) break;
+
+    if (!rowStart) {
+      rowStart = tok.text;
+      while (rowStart > begin && rowStart[-1] != '\n') rowStart--;
+      line = tok.line;
+      field = 0;
+      row = kHashSeed;
+      for (int c = 0; c < COL_COUNT; c++) fields[c] = kHashSeed;
+    }
+    uint64_t v = token_key(tok);
+    row = hash_mix(row, v);
+    if (code == SEPARATOR)
+      field++;
+    else if (field < COL_COUNT)
+      fields[field] = hash_mix(fields[field], v);
+  }
+}
+
+void sketch_parallel( const char* begin, const char* end, int threads,
+                      size_t chunkSize, int& line, const SketchSpec& spec,
+                      Sketches& total )
+{
+  std::vector<Sketches> parts(chunk_slots(threads), Sketches(spec));
+
+  for_each_chunk(begin, end, threads, chunkSize, line,
+    [&](const ChunkRange& c) {
+      parts[c.slot].clear();
+      sketch_rows(c.begin, c.end, c.firstLine, spec, parts[c.slot]);
+    },
+    [&](const ChunkRange& c) {
+      total.merge(parts[c.slot]);
+      return true;
+    });
+}
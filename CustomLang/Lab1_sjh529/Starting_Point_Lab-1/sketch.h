@@ -0,0 +1,129 @@
+//*****************************************************************************
+// purpose: approximate analytics for Lab 1 (lex --distinct=COLUMNS
+//          --sample=N) in fixed memory and one pass
+// version: Fall 2024
+//
+// --distinct=case_date,sex estimates how many distinct combinations of the
+// listed columns the rows hold; --distinct=row how many distinct rows
+// (rows as --dedup compares them, dedup.h). Each estimate is a
+// HyperLogLog sketch of 2^14 one-byte registers (16 KiB, whatever the
+// input size): a value's hash picks a register with its top 14 bits and
+// the register keeps the longest run of leading zeros seen in the rest.
+// The standard error is 1.04 / sqrt(2^14) = 0.81%; the driver prints the
+// 95% interval (two standard errors). Small counts use linear counting
+// on the empty registers and come out nearly exact.
+//
+// --sample=N keeps a uniform sample of N rows without replacement: every
+// row gets a pseudo-random priority from its line number and the seed
+// (--seed=S), and RowSample keeps the N rows with the smallest ones (a
+// bottom-k sample) in a heap. Most rows fail one compare against the
+// heap's top, so sampling costs nothing measurable; the expected number
+// of rows copied into the heap is N * ln(rows / N).
+//
+// Both merge exactly (register maximum, the N smallest priorities), so
+// chunks are sketched on separate threads (parallel.h) and the result is
+// the same for any --threads and --chunk-size.
+//*****************************************************************************
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class HyperLogLog
+{
+public:
+  static const int kBits = 14;                // 2^kBits registers
+
+  HyperLogLog();
+
+  void add( uint64_t hash )
+  {
+    size_t i = hash >> (64 - kBits);
+    uint64_t rest = (hash << kBits) | (1ull << (kBits - 1));   // rank <= 64 - kBits + 1
+    uint8_t rank = (uint8_t)__builtin_clzll(rest) + 1;
+    if (rank > registers_[i]) registers_[i] = rank;
+  }
+
+  void   clear();
+  void   merge( const HyperLogLog& other );
+  double estimate() const;
+  size_t bytes() const { return sizeof registers_; }
+
+  // One standard error, relative to the estimate
+  static double relativeError();
+
+private:
+  uint8_t registers_[1 << kBits];
+};
+
+struct SampledRow
+{
+  uint64_t    priority;
+  int         line;
+  std::string text;      // the row, with its newline
+};
+
+class RowSample
+{
+public:
+  explicit RowSample( size_t size = 0 ) : size_(size) {}
+
+  // Would a row with `priority` be kept? (checked before copying it)
+  bool wants( uint64_t priority ) const
+  {
+    return heap_.size() < size_ || priority < heap_.front().priority;
+  }
+  void add( uint64_t priority, int line, const char* begin, const char* end );
+
+  void clear() { heap_.clear(); }
+  void merge( const RowSample& other );
+
+  size_t size() const { return heap_.size(); }
+
+  // The sample in input order
+  void rows( std::vector<SampledRow>& out ) const;
+
+private:
+  size_t                  size_;
+  std::vector<SampledRow> heap_;   // max-heap on priority
+};
+
+// What to estimate: one column set per --distinct (kRowKey: the whole row)
+const uint32_t kRowKey = 0;
+
+struct SketchSpec
+{
+  std::vector<uint32_t>    keys;    // bit c: column c (records.h); or kRowKey
+  std::vector<std::string> names;   // as given on the command line
+  size_t                   sample;  // rows to keep, 0 for none
+  uint64_t                 seed;
+};
+
+struct Sketches
+{
+  long                     rows;       // lines with at least one token
+  std::vector<HyperLogLog> distinct;   // by spec.keys
+  RowSample                sample;
+
+  explicit Sketches( const SketchSpec& spec );
+  void clear();
+  void merge( const Sketches& other );
+};
+
+// Parse "case_date,sex" (column names as for --histogram) or "row" into a
+// column set; false if a name is not a column
+bool parse_sketch_key( const char* text, uint32_t& key );
+
+// Sketch the rows of [begin, end), which starts on `firstLine`
+void sketch_rows( const char* begin, const char* end, int firstLine,
+                  const SketchSpec& spec, Sketches& out );
+
+// The same on `threads` threads; adds to `total` and advances `line`
+void sketch_parallel( const char* begin, const char* end, int threads,
+                      size_t chunkSize, int& line, const SketchSpec& spec,
+                      Sketches& total );
+
+#endif
@@ -0,0 +1,113 @@
+//*****************************************************************************
+// purpose: input sources for the Lab 1 engines - see source.h
+// version: Fall 2024
+//*****************************************************************************
+#include "source.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "gzsource.h"
+#include "uringsource.h"
+
+static bool gUring = false;
+
+void source_set_uring( bool on )
+{
+  gUring = on;
+}
+
+bool MappedSource::open( const char* path )
+{
+  done_ = false;
+  return file_.open(path);
+}
+
+bool MappedSource::next( const char*& begin, const char*& end )
+{
+  if (done_) return false;
+  done_ = true;
+  begin = file_.data();
+  end = file_.end();
+  return true;
+}
+
+ChunkSource* open_source( const char* path )
+{
+  // Pipes cannot be sniffed without losing the bytes read: they always go
+  // to GzipSource, which passes data that is not gzip through unchanged.
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return NULL;
+  struct stat st;
+  unsigned char magic[2] = { 0, 0 };
+  bool gzip = fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+              (pread(fd, magic, 2, 0) == 2 && magic[0] == 0x1f && magic[1] == 0x8b);
+  close(fd);
+
+  if (gzip) {
+    GzipSource* gz = new GzipSource;
+    if (gz->open(path)) return gz;
+    delete gz;
+    return NULL;
+  }
+  if (gUring) {
+    UringSource* u = new UringSource;
+    if (u->open(path)) return u;
+    delete u;
+    return NULL;
+  }
+  MappedSource* m = new MappedSource;
+  if (m->open(path)) return m;
+  delete m;
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// stdio adapter (fopencookie) so flex can read any source through yyin
+//-----------------------------------------------------------------------------
+namespace
+{
+
+struct Cookie
+{
+  ChunkSource* src;
+  const char*  p;
+  const char*  end;
+};
+
+ssize_t cookie_read( void* c, char* buf, size_t size )
+{
+  Cookie* k = (Cookie*)c;
+  while (k->p == k->end)
+    if (!k->src->next(k->p, k->end))
+      return k->src->error().empty() ? 0 : -1;
+  size_t n = k->end - k->p < (ptrdiff_t)size ? k->end - k->p : size;
+  memcpy(buf, k->p, n);
+  k->p += n;
+  return n;
+}
+
+int cookie_close( void* c )
+{
+  Cookie* k = (Cookie*)c;
+  delete k->src;
+  delete k;
+  return 0;
+}
+
+} // namespace
+
+FILE* source_fopen( ChunkSource* src )
+{
+  Cookie* k = new Cookie;
+  k->src = src;
+  k->p = k->end = NULL;
+  cookie_io_functions_t io;
+  memset(&io, 0, sizeof io);
+  io.read = cookie_read;
+  io.close = cookie_close;
+  FILE* f = fopencookie(k, "r", io);
+  if (!f) cookie_close(k);
+  return f;
+}
@@ -0,0 +1,61 @@
+//*****************************************************************************
+// purpose: input sources for the Lab 1 engines
+// version: Fall 2024
+//
+// A ChunkSource hands the input to a scanner as a series of buffers. Every
+// buffer except the last ends just after a '\n'. No token spans a newline,
+// so each buffer can be scanned on its own: start a FastScanner with the
+// previous scanner's line() and the tokens and line numbers come out as in
+// one pass over the whole file.
+//
+//   MappedSource - a mapped file, as one buffer (mapfile.h)
+//   GzipSource   - gzip data inflated on a separate thread (gzsource.h)
+//   UringSource  - a file read ahead with io_uring (uringsource.h, --uring)
+//*****************************************************************************
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stdio.h>
+#include <string>
+#include "mapfile.h"
+
+class ChunkSource
+{
+public:
+  virtual ~ChunkSource() {}
+
+  // Next buffer of whole lines; false at the end of input or on an error.
+  // The previous buffer is invalid after this call.
+  virtual bool next( const char*& begin, const char*& end ) = 0;
+
+  // Set when next() stopped because of an error
+  const std::string& error() const { return error_; }
+
+protected:
+  std::string error_;
+};
+
+class MappedSource : public ChunkSource
+{
+public:
+  bool open( const char* path );
+  bool next( const char*& begin, const char*& end );
+
+private:
+  MappedFile file_;
+  bool       done_;
+};
+
+// Open `path` with the right source: a regular file starting with the gzip
+// magic bytes, or a pipe, gets a GzipSource; any other file a MappedSource,
+// or a UringSource after source_set_uring(true). NULL if it cannot be
+// opened.
+ChunkSource* open_source( const char* path );
+
+// Read plain files with UringSource instead of mapping them
+void source_set_uring( bool on );
+
+// A stdio stream reading the source, for yyin; closing it deletes `src`
+FILE* source_fopen( ChunkSource* src );
+
+#endif
@@ -0,0 +1,53 @@
+//*****************************************************************************
+// purpose: fixed-size token counters for the Lab 1 aggregate modes - see tally.h
+// version: Fall 2024
+//*****************************************************************************
+#include "tally.h"
+
+#include <string.h>
+#include "records.h"
+#include "tokens.h"
+
+Tally::Tally( int histColumn )
+  : histColumn(histColumn), line(0), field(0)
+{
+  memset(tokens, 0, sizeof tokens);
+  memset(column, 0, sizeof column);
+}
+
+void Tally::merge( const Tally& other )
+{
+  for (int c = 0; c < kMaxTokenCode; c++) {
+    tokens[c] += other.tokens[c];
+    column[c] += other.column[c];
+  }
+}
+
+long Tally::total() const
+{
+  long n = 0;
+  for (int c = 0; c < kMaxTokenCode; c++) n += tokens[c];
+  return n;
+}
+
+void print_counts( const Tally& t, FILE* out )
+{
+  fprintf(out, "%-18s %12s\n", "token", "count");
+  for (int c = 0; c < kMaxTokenCode; c++)
+    if (t.tokens[c])
+      fprintf(out, "%-18s %12ld\n", token_name(c), t.tokens[c]);
+  fprintf(out, "%-18s %12ld\n", "total", t.total());
+}
+
+void print_histogram( const Tally& t, FILE* out )
+{
+  long n = 0;
+  fprintf(out, "%s (column %d)\n", column_name(t.histColumn), t.histColumn + 1);
+  fprintf(out, "%-18s %12s\n", "value", "count");
+  for (int c = 0; c < kMaxTokenCode; c++)
+    if (t.column[c]) {
+      fprintf(out, "%-18s %12ld\n", token_name(c), t.column[c]);
+      n += t.column[c];
+    }
+  fprintf(out, "%-18s %12ld\n", "total", n);
+}
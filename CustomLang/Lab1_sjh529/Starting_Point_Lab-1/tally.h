@@ -0,0 +1,51 @@
+//*****************************************************************************
+// purpose: fixed-size token counters for the Lab 1 aggregate modes
+// version: Fall 2024
+//
+// lex --quiet / --count / --histogram=COLUMN feed every token into a Tally
+// instead of printing it. A Tally is two arrays indexed by token code, so
+// adding a token is two increments. Tallies of separate chunks merge by
+// addition (parallel.h).
+//*****************************************************************************
+#ifndef TALLY_H
+#define TALLY_H
+
+#include <stdio.h>
+#include "lexer.h"
+
+const int kMaxTokenCode = 100;   // token codes are 0..99 (lexer.h)
+
+struct Tally
+{
+  long tokens[kMaxTokenCode];   // all tokens, by code
+  long column[kMaxTokenCode];   // tokens in histColumn, by code
+  int  histColumn;              // field index for --histogram, or -1
+  int  line;                    // line of the previous token
+  int  field;                   // field index within that line
+
+  explicit Tally( int histColumn = -1 );
+
+  // Count one token found on `line` (EOF_TOKEN is not a token)
+  void add( int code, int line )
+  {
+    if (line != this->line) {
+      this->line = line;
+      field = 0;
+    }
+    if ((unsigned)code >= (unsigned)kMaxTokenCode) return;
+    tokens[code]++;
+    if (code == SEPARATOR) field++;
+    else if (field == histColumn) column[code]++;
+  }
+
+  void merge( const Tally& other );
+  long total() const;
+};
+
+// "token  count" table of the non-zero token counts, then the total
+void print_counts( const Tally& t, FILE* out );
+
+// "value  count" table for the histogram column
+void print_histogram( const Tally& t, FILE* out );
+
+#endif
@@ -0,0 +1,77 @@
+//*****************************************************************************
+// purpose: token names and output formatting - see tokens.h
+// version: Fall 2024
+//*****************************************************************************
+#include "tokens.h"
+
+#include <string.h>
+
+// Logical name of a token code
+const char* token_name( int token )
+{
+  switch( token )
+  {
+    case DATE:             return "DATE";
+    case SEPARATOR:        return "SEPARATOR";
+    case YES:              return "YES";
+    case NO:               return "NO";
+    case UNKNOWN_VALUE:    return "UNKNOWN_VALUE";
+    case MISSING:          return "MISSING";
+
+    case LABORATORY:       return "LABORATORY";
+    case PROBABLE:         return "PROBABLE";
+
+    case MALE:             return "MALE";
+    case FEMALE:           return "FEMALE";
+    case OTHER:            return "OTHER";
+
+    case AGE_0X:           return "AGE_0X";
+    case AGE_1X:           return "AGE_1X";
+    case AGE_2X:           return "AGE_2X";
+    case AGE_4X:           return "AGE_4X";
+    case AGE_5X:           return "AGE_5X";
+    case AGE_6X:           return "AGE_6X";
+    case AGE_7X:           return "AGE_7X";
+    case AGE_8X:           return "AGE_8X";
+
+    case HISPANIC:         return "HISPANIC";
+    case NATIVE_AMERICAN:  return "NATIVE_AMERICAN";
+    case ASIAN:            return "ASIAN";
+    case BLACK:            return "BLACK";
+    case PACIFIC_ISLANDER: return "PACIFIC_ISLANDER";
+    case WHITE:            return "WHITE";
+    case MULTIPLE_OTHER:   return "MULTIPLE_OTHER";
+    case EOF_TOKEN:        return "EOF_TOKEN";
+    case UNKNOWN_TOKEN:    return "UNKNOWN_TOKEN";
+
+    default:               return "=== unmapped token name ===";
+  }
+}
+
+// Decimal digits of a non-negative int, written backwards from `end`
+static char* put_int( char* end, int v )
+{
+  unsigned u = v < 0 ? 0u - (unsigned)v : (unsigned)v;
+  do { *--end = (char)('0' + u % 10); u /= 10; } while (u);
+  if (v < 0) *--end = '-';
+  return end;
+}
+
+void append_token( std::string& out, const ScanToken& tok )
+{
+  char num[16];
+  char* n;
+  out.append("line: ", 6);
+  n = put_int(num + sizeof num, tok.line);
+  out.append(n, num + sizeof num - n);
+  out.append("  lexeme: |", 11);
+  // %s stops at a NUL byte, so the lexeme does too
+  const char* nul = (const char*)memchr(tok.text, 0, tok.length);
+  out.append(tok.text, nul ? nul - tok.text : tok.length);
+  out.append("|  length: ", 11);
+  n = put_int(num + sizeof num, tok.length);
+  out.append(n, num + sizeof num - n);
+  out.append("  token: ", 9);
+  out += token_name(tok.code);
+  out += '\n';
+}
@@ -0,0 +1,19 @@
+//*****************************************************************************
+// purpose: token names and output formatting shared by the Lab 1 engines
+// version: Fall 2024
+//*****************************************************************************
+#ifndef TOKENS_H
+#define TOKENS_H
+
+#include <string>
+#include "fastscan.h"
+
+// Logical name of a token code ("DATE", "SEPARATOR", ...)
+const char* token_name( int token );
+
+// Append the driver's line for one token:
+//   line: N  lexeme: |...|  length: N  token: NAME\n
+// byte for byte what printf("...|%s|...") prints for the flex scanner
+void append_token( std::string& out, const ScanToken& tok );
+
+#endif
@@ -0,0 +1,258 @@
+//*****************************************************************************
+// purpose: io_uring input for the Lab 1 engines - see uringsource.h
+// version: Fall 2024
+//*****************************************************************************
+#include "uringsource.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+namespace
+{
+
+int sys_setup( unsigned entries, struct io_uring_params* p )
+{
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+int sys_enter( int ring, unsigned submit, unsigned wait, unsigned flags )
+{
+  return (int)syscall(__NR_io_uring_enter, ring, submit, wait, flags, NULL, 0);
+}
+
+} // namespace
+
+bool uring_available()
+{
+  static int available = -1;
+  if (available < 0) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof p);
+    int ring = sys_setup(1, &p);
+    available = ring >= 0;
+    if (ring >= 0) close(ring);
+  }
+  return available;
+}
+
+UringSource::UringSource()
+  : fd_(-1), size_(0), nextRead_(0), current_(0), handed_(-1), done_(false),
+    ring_(-1), sqMap_(MAP_FAILED), sqMapSize_(0), cqMap_(MAP_FAILED), cqMapSize_(0),
+    sqes_(MAP_FAILED), sqesSize_(0), inFlight_(0)
+{
+  memset(slots_, 0, sizeof slots_);
+}
+
+UringSource::~UringSource()
+{
+  // the kernel may still be writing into the buffers
+  while (ring_ >= 0 && inFlight_ > 0) reap(true);
+  if (sqes_ != MAP_FAILED) munmap(sqes_, sqesSize_);
+  if (cqMap_ != MAP_FAILED && cqMap_ != sqMap_) munmap(cqMap_, cqMapSize_);
+  if (sqMap_ != MAP_FAILED) munmap(sqMap_, sqMapSize_);
+  if (ring_ >= 0) close(ring_);
+  if (fd_ >= 0) close(fd_);
+  for (int i = 0; i < kSlots; i++) free(slots_[i].base);
+}
+
+bool UringSource::setupRing()
+{
+  struct io_uring_params p;
+  memset(&p, 0, sizeof p);
+  ring_ = sys_setup(kSlots, &p);
+  if (ring_ < 0) return false;
+
+  sqMapSize_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cqMapSize_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    if (cqMapSize_ > sqMapSize_) sqMapSize_ = cqMapSize_;
+    cqMapSize_ = sqMapSize_;
+  }
+  sqMap_ = mmap(NULL, sqMapSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring_, IORING_OFF_SQ_RING);
+  if (sqMap_ != MAP_FAILED)
+    cqMap_ = (p.features & IORING_FEAT_SINGLE_MMAP) ? sqMap_ :
+             mmap(NULL, cqMapSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ring_, IORING_OFF_CQ_RING);
+  sqesSize_ = p.sq_entries * sizeof(struct io_uring_sqe);
+  if (cqMap_ != MAP_FAILED)
+    sqes_ = mmap(NULL, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                 ring_, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    if (cqMap_ != MAP_FAILED && cqMap_ != sqMap_) munmap(cqMap_, cqMapSize_);
+    if (sqMap_ != MAP_FAILED) munmap(sqMap_, sqMapSize_);
+    sqMap_ = cqMap_ = MAP_FAILED;
+    close(ring_);
+    ring_ = -1;
+    return false;
+  }
+
+  char* sq = (char*)sqMap_;
+  char* cq = (char*)cqMap_;
+  sqTail_ = (unsigned*)(sq + p.sq_off.tail);
+  sqMask_ = (unsigned*)(sq + p.sq_off.ring_mask);
+  sqArray_ = (unsigned*)(sq + p.sq_off.array);
+  cqHead_ = (unsigned*)(cq + p.cq_off.head);
+  cqTail_ = (unsigned*)(cq + p.cq_off.tail);
+  cqMask_ = (unsigned*)(cq + p.cq_off.ring_mask);
+  cqes_ = cq + p.cq_off.cqes;
+  return true;
+}
+
+bool UringSource::open( const char* path )
+{
+  fd_ = ::open(path, O_RDONLY);
+  if (fd_ < 0) return false;
+  struct stat st;
+  if (fstat(fd_, &st) != 0) return false;
+  size_ = st.st_size;
+  posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  for (int i = 0; i < kSlots; i++) {
+    void* p;
+    if (posix_memalign(&p, 4096, kHeadroom + kSlotSize) != 0) return false;
+    slots_[i].base = (char*)p;
+    slots_[i].data = slots_[i].base + kHeadroom;
+  }
+  setupRing();   // else pread
+  for (int i = 0; i < kSlots; i++) submit(i);
+  return true;
+}
+
+void UringSource::submit( int i )
+{
+  Slot& s = slots_[i];
+  if (nextRead_ >= size_) {
+    s.state = IDLE;
+    return;
+  }
+  s.offset = nextRead_;
+  s.length = size_ - nextRead_ < (off_t)kSlotSize ? size_ - nextRead_ : kSlotSize;
+  nextRead_ += s.length;
+  s.state = PENDING;
+
+  if (ring_ < 0) {
+    s.result = pread(fd_, s.data, s.length, s.offset);
+    if (s.result < 0) s.result = -errno;
+    s.state = READY;
+    return;
+  }
+  unsigned tail = *sqTail_;
+  unsigned index = tail & *sqMask_;
+  struct io_uring_sqe* sqe = (struct io_uring_sqe*)sqes_ + index;
+  memset(sqe, 0, sizeof *sqe);
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = fd_;
+  sqe->addr = (uint64_t)(uintptr_t)s.data;
+  sqe->len = (uint32_t)s.length;
+  sqe->off = (uint64_t)s.offset;
+  sqe->user_data = (uint64_t)i;
+  sqArray_[index] = index;
+  __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+  inFlight_++;
+  if (sys_enter(ring_, 1, 0, 0) < 0) {
+    // not queued after all: read it here
+    __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+    inFlight_--;
+    s.result = pread(fd_, s.data, s.length, s.offset);
+    if (s.result < 0) s.result = -errno;
+    s.state = READY;
+  }
+}
+
+void UringSource::reap( bool wait )
+{
+  unsigned head = *cqHead_;
+  if (wait && head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE))
+    sys_enter(ring_, 0, 1, IORING_ENTER_GETEVENTS);
+  unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++) {
+    struct io_uring_cqe* cqe = (struct io_uring_cqe*)cqes_ + (head & *cqMask_);
+    Slot& s = slots_[cqe->user_data];
+    s.result = cqe->res;
+    s.state = READY;
+    inFlight_--;
+  }
+  __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+}
+
+bool UringSource::await( int i )
+{
+  Slot& s = slots_[i];
+  while (s.state == PENDING) reap(true);
+
+  // a short read (or a kernel without IORING_OP_READ): finish with pread
+  size_t have = s.result > 0 ? s.result : 0;
+  if (s.result == -EINVAL || s.result == -EINTR || s.result == -EAGAIN || s.result >= 0)
+    while (have < s.length) {
+      ssize_t n = pread(fd_, s.data + have, s.length - have, s.offset + have);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        s.result = n < 0 ? -errno : (ssize_t)have;
+        break;
+      }
+      have += n;
+      s.result = have;
+    }
+  if (s.result < 0) {
+    error_ = std::string("read: ") + strerror((int)-s.result);
+    return false;
+  }
+  return true;
+}
+
+bool UringSource::next( const char*& begin, const char*& end )
+{
+  if (done_) return false;
+  for (;;) {
+    // the buffer handed out last time is free: queue the next read into it
+    if (handed_ >= 0) submit(handed_);
+    handed_ = -1;
+
+    Slot& s = slots_[current_];
+    if (s.state == IDLE) {
+      // the end of the file: what is left is a last line without a newline
+      done_ = true;
+      if (carry_.empty()) return false;
+      spill_.swap(carry_);
+      begin = spill_.data();
+      end = begin + spill_.size();
+      return true;
+    }
+    if (!await(current_)) {
+      done_ = true;
+      return false;
+    }
+
+    char* data = s.data;
+    size_t n = s.result;
+    handed_ = current_;
+    current_ = (current_ + 1) % kSlots;
+    const char* nl = n ? (const char*)memrchr(data, '\n', n) : NULL;
+    if (!nl) {
+      carry_.append(data, n);   // all of it belongs to a longer line
+      continue;
+    }
+
+    if (carry_.size() <= kHeadroom) {
+      begin = data - carry_.size();
+      memcpy(data - carry_.size(), carry_.data(), carry_.size());
+      end = nl + 1;
+    }
+    else {
+      spill_.swap(carry_);
+      spill_.append(data, nl + 1 - data);
+      begin = spill_.data();
+      end = begin + spill_.size();
+    }
+    carry_.assign(nl + 1, (const char*)data + n);
+    return true;
+  }
+}
@@ -0,0 +1,94 @@
+//*****************************************************************************
+// purpose: io_uring input for the Lab 1 engines (lex --uring file.csv)
+// version: Fall 2024
+//
+// A mapped file (MappedSource) is read by page faults: on a file that is
+// not in the page cache the scanner stops at every fault that readahead
+// has not covered yet. UringSource instead keeps kSlots reads of
+// kSlotSize bytes in flight with io_uring, into page-aligned buffers, and
+// the scanner works on the oldest one while the others fill. A buffer
+// goes back into the queue, for the next part of the file, as soon as the
+// scanner asks for the following one.
+//
+// Each buffer is handed out up to its last newline. The partial line is
+// copied into the headroom just before the next buffer, so whole lines
+// come out without moving the data; a line longer than the headroom is
+// put together in a separate buffer.
+//
+// The ring is set up with the raw system calls (no liburing). Where
+// io_uring is not available (old kernels, seccomp) the same buffers are
+// filled with pread, one at a time; uring_available() tells which.
+//*****************************************************************************
+#ifndef URINGSOURCE_H
+#define URINGSOURCE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <string>
+#include "source.h"
+
+class UringSource : public ChunkSource
+{
+public:
+  static const int    kSlots    = 4;           // reads in flight
+  static const size_t kSlotSize = 4 << 20;     // bytes per read
+  static const size_t kHeadroom = 64 << 10;    // room for a carried partial line
+
+  UringSource();
+  ~UringSource();
+
+  bool open( const char* path );
+  bool next( const char*& begin, const char*& end );
+
+  bool async() const { return ring_ >= 0; }   // false: pread fallback
+
+private:
+  enum SlotState { IDLE, PENDING, READY };
+
+  struct Slot
+  {
+    char*     base;     // kHeadroom + kSlotSize bytes, page-aligned
+    char*     data;     // base + kHeadroom
+    off_t     offset;   // file offset of data[0]
+    size_t    length;   // bytes asked for
+    ssize_t   result;   // bytes read, or -errno
+    SlotState state;
+  };
+
+  bool setupRing();
+  void submit( int slot );    // read the next part of the file into slot
+  bool await( int slot );     // until the slot is READY; false on an error
+  void reap( bool wait );     // collect completions
+
+  int    fd_;
+  off_t  size_;
+  off_t  nextRead_;           // file offset of the next read to submit
+  Slot   slots_[kSlots];
+  int    current_;            // slot to hand out next
+  int    handed_;             // slot handed out by the last next(), or -1
+  std::string carry_;         // partial line after the last newline
+  std::string spill_;         // a line longer than kHeadroom, put together
+  bool   done_;
+
+  // the ring (see io_uring_setup(2)); ring_ < 0 when pread is used
+  int       ring_;
+  void*     sqMap_;
+  size_t    sqMapSize_;
+  void*     cqMap_;
+  size_t    cqMapSize_;
+  void*     sqes_;
+  size_t    sqesSize_;
+  unsigned* sqTail_;
+  unsigned* sqMask_;
+  unsigned* sqArray_;
+  unsigned* cqHead_;
+  unsigned* cqTail_;
+  unsigned* cqMask_;
+  void*     cqes_;
+  int       inFlight_;
+};
+
+// Can this process use io_uring? (checked once)
+bool uring_available();
+
+#endif
@@ -0,0 +1,194 @@
+// ============================================================================
+// batch.cpp - One sentence per line, on one or more threads (see batch.h)
+// ============================================================================
+
+#include "batch.h"
+#include "lexer.h"     // Scanner
+#include "parser.h"    // Parser
+#include "printer.h"   // Printer visitor
+#include "debug.h"     // gDebug
+#include <algorithm>   // count
+#include <chrono>
+#include <condition_variable>
+#include <cstring>     // memchr
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+using namespace std;
+
+static const size_t kBlockBytes = 1 << 18;   // text per block (whole lines)
+
+// A block of whole lines and, once parsed, what it prints.
+struct Block {
+    string text;            // the lines, each ending in '\n' (maybe not the last)
+    long firstLine = 0;     // line number of the first line
+    string out, err;        // for stdout / stderr, in line order
+    long passed = 0, failed = 0;
+    bool done = false;      // parsed (guarded by the pipeline's mutex)
+};
+
+// Read the next block of whole lines; `carry` keeps a partial last line for
+// the next call. False at the end of the input.
+static bool readBlock(istream& in, string& carry, long& lineNo, Block& block) {
+    block.text.swap(carry);
+    carry.clear();
+    size_t cut;
+    for (;;) {
+        size_t have = block.text.size();
+        block.text.resize(have + kBlockBytes);
+        in.read(&block.text[have], kBlockBytes);
+        block.text.resize(have + in.gcount());
+        cut = block.text.rfind('\n');
+        if (!in || cut != string::npos) break;   // the end, or some whole lines
+        // a line longer than a block: read on, the block just gets bigger
+    }
+    if (block.text.empty()) return false;
+
+    // Cut after the last newline; keep the rest for next time.
+    if (in && cut + 1 < block.text.size()) {
+        carry.assign(block.text, cut + 1, string::npos);
+        block.text.resize(cut + 1);
+    }
+    block.firstLine = lineNo;
+    lineNo += count(block.text.begin(), block.text.end(), '\n');
+    if (block.text.back() != '\n') ++lineNo;   // the last line, without a newline
+    return true;
+}
+
+// Parse every line of a block with one thread's scanner and parser.
+static void parseBlock(Block& block, Scanner& lexer, Parser& parser, bool compact) {
+    ostringstream out, err;
+    const char* p = block.text.data();
+    const char* end = p + block.text.size();
+    long lineNo = block.firstLine;
+
+    for (; p < end; ++lineNo) {
+        const char* nl = (const char*)memchr(p, '\n', end - p);
+        const char* eol = nl ? nl : end;
+        string_view line(p, eol - p);
+        p = eol + 1;
+        if (line.find_first_not_of(" \t\r") == string_view::npos) continue;  // blank line
+
+        lexer.scanLine(line.data(), line.size());
+        try {
+            auto root = parser.parseStart();
+            ++block.passed;
+            if (compact) {
+                out << lineNo << ": ok\n";
+            } else {
+                out << "line " << lineNo << ":\n";
+                Printer pp(out);
+                root->accept(pp);
+            }
+        } catch (const runtime_error& e) {
+            ++block.failed;
+            if (compact) out << lineNo << ": FAIL " << e.what() << "\n";
+            else         err << "line " << lineNo << ": " << e.what() << "\n";
+        }
+        lexer.endLine();
+    }
+    block.out = out.str();
+    block.err = err.str();
+}
+
+int runBatch(istream& in, const BatchOptions& options) {
+    long lineNo = 1, passed = 0, failed = 0;
+    string carry;
+    auto start = chrono::steady_clock::now();
+
+    auto write = [&](const Block& block) {
+        cout << block.out;
+        cerr << block.err;
+        passed += block.passed;
+        failed += block.failed;
+    };
+
+    if (options.threads <= 1) {
+        // One thread: read, parse, write, block after block.
+        Scanner lexer;
+        lexer.setDebug(gDebug);
+        Parser parser(lexer);
+        Block block;
+        while (readBlock(in, carry, lineNo, block)) {
+            parseBlock(block, lexer, parser, options.compact);
+            write(block);
+            block.passed = block.failed = 0;
+        }
+    } else {
+        // Workers take blocks from `todo`; the main thread reads blocks into
+        // `window` and writes them out from its front, in input order.
+        mutex m;
+        condition_variable workReady, blockDone;
+        deque<Block*> todo;                  // read, not yet taken by a worker
+        deque<unique_ptr<Block>> window;     // read, not yet written (main only)
+        bool finished = false;
+
+        vector<thread> workers;
+        for (int t = 0; t < options.threads; ++t) {
+            workers.emplace_back([&]() {
+                Scanner lexer;               // this thread's own scanner ...
+                Parser parser(lexer);        // ... and parser (lookahead)
+                unique_lock<mutex> lock(m);
+                for (;;) {
+                    workReady.wait(lock, [&]() { return !todo.empty() || finished; });
+                    if (todo.empty()) return;
+                    Block* block = todo.front();
+                    todo.pop_front();
+                    lock.unlock();
+                    parseBlock(*block, lexer, parser, options.compact);
+                    lock.lock();
+                    block->done = true;
+                    blockDone.notify_one();  // only the main thread waits
+                }
+            });
+        }
+
+        const size_t maxAhead = 4 * (size_t)options.threads;
+        bool more = true;
+        for (;;) {
+            while (more && window.size() < maxAhead) {
+                auto block = make_unique<Block>();
+                more = readBlock(in, carry, lineNo, *block);
+                if (!more) break;
+                {
+                    lock_guard<mutex> lock(m);
+                    todo.push_back(block.get());
+                }
+                workReady.notify_one();
+                window.push_back(move(block));
+            }
+            if (window.empty()) break;
+
+            Block& oldest = *window.front();
+            {
+                unique_lock<mutex> lock(m);
+                blockDone.wait(lock, [&]() { return oldest.done; });
+            }
+            write(oldest);
+            window.pop_front();
+        }
+
+        {
+            lock_guard<mutex> lock(m);
+            finished = true;
+        }
+        workReady.notify_all();
+        for (auto& w : workers) w.join();
+    }
+    cout.flush();
+
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    long total = passed + failed;
+    cerr << "sentences: " << total << "  passed: " << passed << "  failed: " << failed
+         << "  time: " << secs << " s  (" << (long)(total / (secs > 0 ? secs : 1e-9))
+         << " sentences/s";
+    if (options.threads > 1) cerr << ", " << options.threads << " threads";
+    cerr << ")\n";
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,38 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// ============================================================================
+// batch.h - Parse a whole corpus, one sentence per line (./parse --batch)
+// ----------------------------------------------------------------------------
+// WHAT IT DOES
+//   Every non-blank line is parsed as its own <sentence> and reported:
+//     --batch          "line N:" and the tree to stdout, or
+//                      "line N: <error>" to stderr
+//     --batch=compact  "N: ok" or "N: FAIL <error>" to stdout
+//   then a summary line (sentences, passed, failed, sentences/s) to stderr.
+//
+// THREADS (--threads=N)
+//   The input is read in blocks of whole lines (about 256 KiB, a few
+//   thousand sentences each). N worker threads take blocks from a queue and
+//   parse them; each worker has its own Scanner and Parser (lexer.h,
+//   parser.h), so they share nothing but the read-only lexicon (vocab.h).
+//   A worker prints a block into its own buffers, and the main thread
+//   writes the buffers in input order, so the output is the same for any
+//   N. At most 4 blocks per worker are read ahead, which bounds memory.
+//   Reading and writing stay on the main thread; parsing is the work that
+//   scales with N.
+// ============================================================================
+
+#include <iostream>
+
+using namespace std;
+
+struct BatchOptions {
+    bool compact = false;   // --batch=compact: one "ok"/"FAIL" line per sentence
+    int  threads = 1;       // --threads=N: parser threads
+};
+
+// Parse every line of `in`; returns the exit status (1 if any line failed).
+int runBatch(istream& in, const BatchOptions& options);
+
+#endif // BATCH_H
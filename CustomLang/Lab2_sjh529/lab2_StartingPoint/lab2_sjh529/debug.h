@@ -18,8 +18,9 @@ using namespace std;
 // Global toggle; off by default. Enable via --debug or set directly if needed.
 inline bool gDebug = false;
 
-// Simple indentation depth for enter/exit tracing.
-inline int gDepth = 0;
+// Simple indentation depth for enter/exit tracing (one per thread: each
+// --threads worker has its own parser, so its own nesting).
+inline thread_local int gDepth = 0;
 
 // RAII helper: increments depth on enter, decrements on scope exit.
 struct DebugIndent {
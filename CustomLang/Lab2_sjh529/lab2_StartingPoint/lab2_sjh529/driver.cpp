@@ -14,11 +14,35 @@
 //   ./parse                      // read from stdin
 //   ./parse input1.in            // read from the file "input1.in"
 //   ./parse --debug input1.in    // enable extra debug tracing to stderr
+//   ./parse --batch corpus.txt   // every line is one sentence (see below)
+//   ./parse --batch=compact corpus.txt
+//   ./parse --batch --threads=8 corpus.txt  // parse on 8 threads, same output
+//   ./parse --vocab=words.txt input1.in   // use the words of a word list
 //
 // WHERE OUTPUT GOES
 //   - Pretty tree  -> stdout
 //   - Debug/errors -> stderr
 //
+// ABOUT --batch (batch.h)
+//   - Each non-blank line is parsed as its own <sentence>: the lexer scans
+//     just that line (Scanner::scanLine in lexer.h) and parseStart() primes
+//     a new lookahead, so one bad line does not affect the next one.
+//   - --batch prints "line N:" and the tree of every good line to stdout,
+//     and "line N: <error>" to stderr for the others.
+//   - --batch=compact prints one result per line to stdout instead:
+//       "N: ok"   or   "N: FAIL <error>"
+//   - At the end a summary goes to stderr: sentences, passed, failed, and
+//     sentences per second. The exit status is 1 if any line failed.
+//   - --threads=N parses on N threads, each with its own scanner and parser.
+//     The output is the same, in input order. (--debug uses one thread, so
+//     its traces stay readable.)
+//
+// ABOUT --vocab=FILE
+//   - The lexer asks the lexicon (vocab.h) what each word is. Without
+//     --vocab it knows the built-in starter words; with it, exactly the
+//     words of FILE ("word PART_OF_SPEECH" per line, see vocab.txt).
+//   - With --debug the number of words and the load time go to stderr.
+//
 // ABOUT --debug
 //   - Turns on parser tracing (debug.h).
 //   - Turns on Flex rule tracing (yy_flex_debug).
@@ -26,56 +50,109 @@
 // ============================================================================
 
 #include <iostream>
+#include <fstream>     // ifstream (--batch)
+#include <chrono>      // steady_clock (--vocab timing)
 #include <cstdio>      // fopen
+#include <cstdlib>     // atoi
 #include <stdexcept>
 #include <string>
-#include "lexer.h"     // yyin (and FILE), token defs
-#include "parser.h"    // parseStart()
+#include "lexer.h"     // Scanner (and FILE), token defs
+#include "parser.h"    // Parser::parseStart()
 #include "printer.h"   // Printer visitor
+#include "batch.h"     // runBatch() (--batch)
+#include "vocab.h"     // gVocabulary (--vocab)
 #include "debug.h"     // gDebug + debug helpers (stderr only)
 
 using namespace std;
 
-// Flex's internal debug flag (1 = on). We set this only when --debug is used.
-extern int yy_flex_debug;
-
-
 int main(int argc, char* argv[]) {
     const char* fileArg = nullptr;  // optional input filename (at most one)
+    bool batch = false;             // --batch: one sentence per line
+    BatchOptions batchOptions;      // --batch=compact, --threads=N
+    string vocabFile;               // --vocab=FILE: word list for the lexicon
 
     // Parse flags first, then an optional filename.
     // Accepted flags:
     //   --debug  or  -d   : enable parser + lexer debug tracing (to stderr)
+    //   --batch[=compact] : one sentence per line (see ABOUT --batch)
+    //   --threads=N       : with --batch, parse on N threads
+    //   --vocab=FILE      : load the lexicon from a word list (see ABOUT --vocab)
     for (int i = 1; i < argc; ++i) {
         string a = argv[i];
         if (a == "--debug" || a == "-d") {
             gDebug = true;            // enable our parser debug (stderr)
+        } else if (a == "--batch" || a == "--batch=compact") {
+            batch = true;
+            batchOptions.compact = (a == "--batch=compact");
+        } else if (a.rfind("--threads=", 0) == 0) {
+            batchOptions.threads = atoi(a.c_str() + 10);
+            if (batchOptions.threads <= 0 ||
+                a.find_first_not_of("0123456789", 10) != string::npos) {
+                cerr << "--threads=N needs a whole number N >= 1, not '" << a.substr(10) << "'\n";
+                return 1;
+            }
+        } else if (a.rfind("--vocab=", 0) == 0 && a.size() > 8) {
+            vocabFile = a.substr(8);
         } else if (!fileArg) {
             fileArg = argv[i];        // remember the first non-flag as input file
         } else {
-            cerr << "Usage: " << argv[0] << " [--debug|-d] [input_file]\n";
+            cerr << "Usage: " << argv[0] << " [--debug|-d] [--batch[=compact] [--threads=N]] [--vocab=FILE] [input_file]\n";
             return 1;
         }
     }
 
-    // If --debug is on, also enable Flex's own rule tracing (stderr).
-    yy_flex_debug = 0;          // force OFF by default
-    if (gDebug) yy_flex_debug = 1;   // turn ON only with --debug / -d
+    if (batchOptions.threads > 1 && !batch) {
+        cerr << "--threads=N needs --batch\n";
+        return 1;
+    }
+    if (gDebug) batchOptions.threads = 1;   // one trace, not several interleaved
+
+    // Set up the lexicon before the lexer sees its first word.
+    if (vocabFile.empty()) {
+        gVocabulary.loadBuiltin();
+    } else {
+        auto start = chrono::steady_clock::now();
+        string error;
+        if (!gVocabulary.load(vocabFile, error)) {
+            cerr << error << "\n";
+            return 1;
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (gDebug) dbg("vocab: " + to_string(gVocabulary.size()) + " words from " +
+                        vocabFile + " in " + to_string(ms) + " ms");
+    }
+
+    // Batch mode reads the lines itself and hands them to the lexer one by one.
+    if (batch) {
+        ios::sync_with_stdio(false);   // we only use iostreams from here on
+        if (fileArg && string(fileArg) != "-") {
+            ifstream file(fileArg);
+            if (!file) {
+                cerr << "Could not open input file: " << fileArg << "\n";
+                return 1;
+            }
+            return runBatch(file, batchOptions);
+        }
+        return runBatch(cin, batchOptions);
+    }
 
     // Choose the input source for the lexer.
+    FILE* input = stdin;        // default: read from standard input (or '-' explicitly)
     if (fileArg && string(fileArg) != "-") {
-        yyin = fopen(fileArg, "r");
-        if (!yyin) {
+        input = fopen(fileArg, "r");
+        if (!input) {
             cerr << "Could not open input file: " << fileArg << "\n";
             return 1;
         }
-    } else {
-        yyin = stdin; // default: read from standard input (or '-' explicitly)
     }
+    Scanner lexer;
+    lexer.setInput(input);
+    lexer.setDebug(gDebug);     // Flex's own rule tracing (stderr), only with --debug
+    Parser parser(lexer);
 
     try {
         // Parse exactly one <sentence>. The parser will throw on the first error.
-        auto root = parseStart();
+        auto root = parser.parseStart();
 
         // Print the fully expanded tree to stdout (this is the graded output).
         Printer pp(cout);
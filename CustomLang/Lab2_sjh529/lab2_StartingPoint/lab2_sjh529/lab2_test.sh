@@ -17,8 +17,10 @@ g++ -std=gnu++17 -Wall -Wextra -O2 -c ast.cpp -o ast.o
 g++ -std=gnu++17 -Wall -Wextra -O2 -c printer.cpp -o printer.o
 g++ -std=gnu++17 -Wall -Wextra -O2 -c parser.cpp -o parser.o
 g++ -std=gnu++17 -Wall -Wextra -O2 -c driver.cpp -o driver.o
+g++ -std=gnu++17 -Wall -Wextra -O2 -c vocab.cpp -o vocab.o
+g++ -std=gnu++17 -Wall -Wextra -O2 -pthread -c batch.cpp -o batch.o
 flex rules.l
-g++ -std=gnu++17 -Wall -Wextra -O2 ast.o printer.o parser.o driver.o lex.yy.c -o parse
+g++ -std=gnu++17 -Wall -Wextra -O2 -pthread ast.o printer.o parser.o driver.o vocab.o batch.o lex.yy.c -o parse
 
 # == Run Tests ==
 for f in input*.in; do
@@ -30,3 +32,55 @@ for f in input*.in; do
         cat "$f.err"
     fi
 done
+
+# == Batch mode: one sentence per line ==
+echo -e "\033[1;33m-- Running batch1.txt (--batch=compact) --\033[0m"
+./parse --batch=compact batch1.txt > batch1.txt.out 2> batch1.txt.err || true
+if diff -u batch1.expected batch1.txt.out; then
+    echo -e "\033[1;32mPASS: batch1.txt\033[0m"
+else
+    echo -e "\033[1;31mFAIL: batch1.txt\033[0m"
+fi
+cat batch1.txt.err
+
+# == Batch mode on several threads: same output, same order ==
+echo -e "\033[1;33m-- Running batch1.txt (--batch=compact --threads=3) --\033[0m"
+./parse --batch=compact --threads=3 batch1.txt > batch1.threads.out 2> /dev/null || true
+if diff -u batch1.expected batch1.threads.out; then
+    echo -e "\033[1;32mPASS: batch1.txt --threads=3\033[0m"
+else
+    echo -e "\033[1;31mFAIL: batch1.txt --threads=3\033[0m"
+fi
+
+# == Word list: the lexicon from a file (--vocab) ==
+echo -e "\033[1;33m-- Running batch1.txt (--vocab=vocab.txt) --\033[0m"
+./parse --batch=compact --vocab=vocab.txt batch1.txt > batch1.vocab.out 2> batch1.vocab.err || true
+if diff -u batch1.vocab.expected batch1.vocab.out; then
+    echo -e "\033[1;32mPASS: batch1.txt --vocab\033[0m"
+else
+    echo -e "\033[1;31mFAIL: batch1.txt --vocab\033[0m"
+fi
+
+# == A word the lexer cannot match is reported with its line ==
+echo -e "\033[1;33m-- Loading vocab_bad.txt --\033[0m"
+if ! ./parse --vocab=vocab_bad.txt input1.in > /dev/null 2> vocab_bad.err &&
+   grep -q "^vocab_bad.txt:5: 'dog2' is not a word" vocab_bad.err; then
+    echo -e "\033[1;32mPASS: vocab_bad.txt\033[0m"
+else
+    echo -e "\033[1;31mFAIL: vocab_bad.txt\033[0m"
+    cat vocab_bad.err
+fi
+
+# == Threads on an input of many blocks: same output, same order ==
+# batch.cpp reads 256 KiB blocks; ~7 MB keeps the reorder window full.
+echo -e "\033[1;33m-- Running a large batch (--threads=1 vs --threads=4) --\033[0m"
+awk '{ line[NR] = $0 } END { for (i = 0; i < 25000; i++) for (j = 1; j <= NR; j++) print line[j] }' \
+    batch1.txt > batch_large.txt
+./parse --batch=compact --threads=1 batch_large.txt > batch_large.1.out 2> /dev/null || true
+./parse --batch=compact --threads=4 batch_large.txt > batch_large.4.out 2> /dev/null || true
+if [ "$(wc -l < batch_large.1.out)" -eq 225000 ] && cmp -s batch_large.1.out batch_large.4.out; then
+    echo -e "\033[1;32mPASS: batch_large.txt --threads=4\033[0m"
+else
+    echo -e "\033[1;31mFAIL: batch_large.txt --threads=4\033[0m"
+fi
+rm -f batch_large.txt batch_large.1.out batch_large.4.out
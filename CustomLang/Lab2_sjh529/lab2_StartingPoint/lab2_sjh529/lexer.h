@@ -13,7 +13,7 @@
 //     (2) update the parser to handle it.
 //
 // Purpose:
-//   - Parser: knows which integer codes yylex() returns.
+//   - Parser: knows which integer codes Scanner::next() (yylex) returns.
 //   - Lexer : can 'return ARTICLE;' etc. using these names.
 //
 // Notes:
@@ -21,8 +21,10 @@
 //   - Named tokens start at 256 to avoid collisions with raw character codes (0..255).
 // ============================================================================
 
+#include <cstddef>  // for std::size_t
 #include <cstdio>   // for std::FILE
 using std::FILE;
+using std::size_t;
 
 // Token codes (distinct integers). Keep named tokens >= 256.
 enum Token : int {
@@ -36,10 +38,35 @@ enum Token : int {
     UNKNOWN
 };
 
-// Scanner interface (provided by Flex in lex.yy.c). Compiled as C++ here.
-int   yylex();       // returns one of the Token values above (or a char code)
-extern char* yytext; // matched lexeme text
-extern FILE* yyin;   // input stream for the lexer (set in driver.cpp)
+// Scanner interface. rules.l uses %option reentrant: all of Flex's state
+// (input, buffers, yytext) lives in one scanner object instead of globals,
+// so several threads can each scan with their own (batch.h --threads).
+// Scanner wraps that object; its members are defined at the end of rules.l,
+// where the Flex types are known. Compiled as C++ here.
+class Scanner {
+public:
+    Scanner();                       // yylex_init
+    ~Scanner();                      // yylex_destroy
+    Scanner(const Scanner&) = delete;
+    Scanner& operator=(const Scanner&) = delete;
+
+    int next();                      // yylex: one of the Token values above
+    const char* text() const;        // matched lexeme text (yytext)
+
+    void setInput(FILE* in);         // read from a file (driver.cpp)
+    void setDebug(bool on);          // Flex's rule tracing (--debug)
+
+    // Batch mode (--batch): scan one line held in memory instead of the
+    // file. After scanLine(), next() returns the tokens of that line and
+    // then TOK_EOF, so parseStart() checks it as a whole sentence.
+    // endLine() frees the line's Flex buffer.
+    void scanLine(const char* text, size_t length);
+    void endLine();
+
+private:
+    void* scanner;                   // yyscan_t
+    void* lineBuffer;                // YY_BUFFER_STATE of scanLine(), or null
+};
 
 
 #endif // LEXER_H
@@ -11,28 +11,19 @@
 #include <string>
 using namespace std;
 
-// Provided by the lexer (Flex)
-extern int yylex();
-extern char* yytext;
-extern FILE* yyin;
-
-
-// Single-token lookahead
-static int lookahead = 0;
-
 // Advance to the next token
-static void next() {
-    lookahead = yylex();
+void Parser::next() {
+    lookahead = lexer.next();
     if (gDebug) {
         if (lookahead == TOK_EOF) dbg("next: TOK_EOF");
-        else dbg(string("next: ") + tokenName(lookahead) + " (" + yytext + ")");
+        else dbg(string("next: ") + tokenName(lookahead) + " (" + lexer.text() + ")");
     }
 }
 
 // Match a specific token and return its lexeme, or throw with the given message.
-static string expect(int tok, const char* msgIfMismatch) {
+string Parser::expect(int tok, const char* msgIfMismatch) {
     if (lookahead == tok) {
-        string lex = yytext;
+        string lex = lexer.text();
         if (gDebug) dbg(string("match ") + tokenName(tok) + " (" + lex + ")");
         next();
         return lex;
@@ -48,7 +39,7 @@ static string expect(int tok, const char* msgIfMismatch) {
 // TODO: define and implement parseSentence, parseNounPhrase, parseAdjectivePhrase,
 //        parseVerbPhrase
 
-unique_ptr<NounPhrase> parseNounPhrase()
+unique_ptr<NounPhrase> Parser::parseNounPhrase()
 {
     dbgLine("Enter <noun phrase");
     DebugIndent _scope;
@@ -63,7 +54,7 @@ unique_ptr<NounPhrase> parseNounPhrase()
     return node;
 }
 
-unique_ptr<VerbPhrase> parseVerbPhrase()
+unique_ptr<VerbPhrase> Parser::parseVerbPhrase()
 {
     dbgLine("enter <verb phrase>");
     DebugIndent _scope;
@@ -81,7 +72,7 @@ unique_ptr<VerbPhrase> parseVerbPhrase()
     return node;
 }
 
-unique_ptr<Sentence> parseSentence()
+unique_ptr<Sentence> Parser::parseSentence()
 {
     dbgLine("enter <sentence>");
     DebugIndent _scope;
@@ -101,7 +92,7 @@ unique_ptr<Sentence> parseSentence()
 // Errors:
 // "<adjective phrase> did not start with an article or possessive."
 // "<adjective phrase> did not have an adjective."
-unique_ptr<AdjectivePhrase> parseAdjectivePhrase() {
+unique_ptr<AdjectivePhrase> Parser::parseAdjectivePhrase() {
 dbgLine("enter <adjective phrase>");
 DebugIndent _scope;
 // FIRST check
@@ -129,7 +120,7 @@ return node;
 
 
 // Entry point: initialize, parse, enforce EOF
-unique_ptr<Sentence> parseStart() {
+unique_ptr<Sentence> Parser::parseStart() {
     next();                      // prime lookahead
     auto root = parseSentence(); // may throw on first syntax error
     if (lookahead != TOK_EOF) {
@@ -30,22 +30,43 @@
 //   "<verb phrase> did not start with a verb or an adverb."
 //
 // HOW TO USE (in main)
-//   auto root = parseStart();   // builds and returns a Sentence*
+//   Scanner lexer;  lexer.setInput(file);
+//   Parser parser(lexer);
+//   auto root = parser.parseStart();   // builds and returns a Sentence*
 //   Printer pp(cout); root->accept(pp);
+//
+// ONE PARSER PER THREAD
+//   A Parser holds the single-token lookahead and reads from its own Scanner,
+//   so several threads can each run one (batch.h --threads). Reuse a Parser
+//   for many sentences: parseStart() primes a fresh lookahead every time.
 // ============================================================================
 
 #include <memory>
+#include <string>
 #include "ast.h"
+#include "lexer.h"
 
 using namespace std;
 
-// Entry: initializes scanning, parses one sentence, enforces EOF.
-unique_ptr<Sentence> parseStart();
+class Parser {
+public:
+    explicit Parser(Scanner& lexer) : lexer(lexer) {}
+
+    // Entry: initializes scanning, parses one sentence, enforces EOF.
+    unique_ptr<Sentence> parseStart();
+
+    // One function per nonterminal (you will implement bodies in parser.cpp).
+    unique_ptr<Sentence>        parseSentence();
+    unique_ptr<NounPhrase>      parseNounPhrase();
+    unique_ptr<AdjectivePhrase> parseAdjectivePhrase();
+    unique_ptr<VerbPhrase>      parseVerbPhrase();
+
+private:
+    void   next();                                  // advance the lookahead
+    string expect(int tok, const char* msgIfMismatch);
 
-// One function per nonterminal (you will implement bodies in parser.cpp).
-unique_ptr<Sentence>        parseSentence();
-unique_ptr<NounPhrase>      parseNounPhrase();
-unique_ptr<AdjectivePhrase> parseAdjectivePhrase();
-unique_ptr<VerbPhrase>      parseVerbPhrase();
+    Scanner& lexer;        // where the tokens come from
+    int lookahead = 0;     // single-token lookahead
+};
 
 #endif // PARSER_H
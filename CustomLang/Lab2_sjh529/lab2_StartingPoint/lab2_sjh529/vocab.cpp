@@ -0,0 +1,186 @@
+// ============================================================================
+// vocab.cpp - The lexicon (see vocab.h)
+// ============================================================================
+
+#include "vocab.h"
+#include "debug.h"     // tokenName (and the token codes)
+#include <fstream>
+#include <sstream>
+using namespace std;
+
+Vocabulary gVocabulary;
+
+// The starter lexicon: the words rules.l used to spell out in its regexes.
+static const struct { const char* word; int token; } kBuiltin[] = {
+    { "the", ARTICLE },     { "a", ARTICLE },        { "an", ARTICLE },
+    { "my", POSSESSIVE },   { "your", POSSESSIVE },  { "his", POSSESSIVE },
+    { "her", POSSESSIVE },  { "our", POSSESSIVE },   { "their", POSSESSIVE },
+    { "green", ADJECTIVE }, { "blue", ADJECTIVE },   { "little", ADJECTIVE },
+    { "small", ADJECTIVE }, { "happy", ADJECTIVE },
+    { "dog", NOUN },        { "trousers", NOUN },    { "pony", NOUN },
+    { "nose", NOUN },       { "homework", NOUN },
+    { "eat", VERB },        { "eats", VERB },        { "ate", VERB },
+    { "quickly", ADVERB },  { "slowly", ADVERB },    { "really", ADVERB },
+};
+
+static inline char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+// Lower-case copy of a word.
+static string lowerCase(const char* text, size_t length) {
+    string key(text, length);
+    for (char& c : key) c = lower(c);
+    return key;
+}
+
+static inline bool isLetter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Can the lexer return this word? It must match WORD_RX in rules.l,
+// [a-z]+(['-][a-z]+)* (caseless): letters, with single ' or - between them.
+static bool isWord(const string& word) {
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (isLetter(word[i])) continue;
+        bool joiner = (word[i] == '\'' || word[i] == '-');
+        if (!joiner || i == 0 || i + 1 == word.size() || !isLetter(word[i + 1]))
+            return false;
+    }
+    return !word.empty();
+}
+
+// FNV-1a of the lower-cased word, so "Dog" and "dog" hash alike.
+static uint64_t hashWord(const char* text, size_t length) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < length; ++i) {
+        h ^= (unsigned char)lower(text[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// The slot to start looking in: the top bits of a well-mixed hash.
+static inline size_t homeSlot(uint64_t hash, size_t mask) {
+    return (size_t)((hash * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+int partOfSpeech(const string& name) {
+    string n = lowerCase(name.data(), name.size());
+    if (n == "article")    return ARTICLE;
+    if (n == "possessive") return POSSESSIVE;
+    if (n == "adjective")  return ADJECTIVE;
+    if (n == "noun")       return NOUN;
+    if (n == "verb")       return VERB;
+    if (n == "adverb")     return ADVERB;
+    return UNKNOWN;
+}
+
+void Vocabulary::clear() {
+    slots.assign(64, Slot{0, 0, 0, 0});
+    text.clear();
+    count = 0;
+}
+
+// Double the table and put every word back in its new place.
+void Vocabulary::grow() {
+    vector<Slot> old(slots.size() * 2, Slot{0, 0, 0, 0});
+    old.swap(slots);
+    size_t mask = slots.size() - 1;
+    for (const Slot& s : old) {
+        if (!s.length) continue;
+        uint64_t h = hashWord(text.data() + s.offset, s.length);
+        size_t i = homeSlot(h, mask);
+        while (slots[i].length) i = (i + 1) & mask;
+        slots[i] = s;
+    }
+}
+
+// The slot holding the word, or nullptr. `word` may be in any case.
+const Vocabulary::Slot* Vocabulary::find(const char* word, size_t length, uint64_t hash) const {
+    if (slots.empty()) return nullptr;
+    size_t mask = slots.size() - 1;
+    for (size_t i = homeSlot(hash, mask); slots[i].length; i = (i + 1) & mask) {
+        const Slot& s = slots[i];
+        if (s.hash != (uint32_t)hash || s.length != length) continue;
+        const char* stored = text.data() + s.offset;
+        size_t k = 0;
+        while (k < length && lower(word[k]) == stored[k]) ++k;
+        if (k == length) return &s;
+    }
+    return nullptr;
+}
+
+bool Vocabulary::add(const string& word, int token, string& error) {
+    if (word.size() > 0xFFFF) {
+        error = "'" + word.substr(0, 40) + "...' is too long";
+        return false;
+    }
+    if (!isWord(word)) {   // e.g. "x2", "café", "end-": the lexer never returns it
+        error = "'" + word + "' is not a word the lexer matches ([a-z]+(['-][a-z]+)*)";
+        return false;
+    }
+    if (slots.empty()) clear();
+    uint64_t h = hashWord(word.data(), word.size());
+    if (const Slot* s = find(word.data(), word.size(), h)) {
+        if (s->token == token) return true;   // listed twice, same part of speech
+        error = "'" + word + "' is already a " + tokenName(s->token);
+        return false;
+    }
+    if (2 * (count + 1) > slots.size()) grow();
+
+    size_t mask = slots.size() - 1;
+    size_t i = homeSlot(h, mask);
+    while (slots[i].length) i = (i + 1) & mask;
+    slots[i] = Slot{(uint32_t)h, (uint32_t)text.size(), (uint16_t)word.size(), (uint16_t)token};
+    text += lowerCase(word.data(), word.size());
+    ++count;
+    return true;
+}
+
+void Vocabulary::loadBuiltin() {
+    clear();
+    string error;
+    for (const auto& w : kBuiltin) add(w.word, w.token, error);
+}
+
+bool Vocabulary::load(const string& path, string& error) {
+    ifstream in(path);
+    if (!in) {
+        error = "Could not open word list: " + path;
+        return false;
+    }
+    clear();
+
+    string line, word, pos, extra;
+    long lineNo = 0;
+    while (getline(in, line)) {
+        ++lineNo;
+        istringstream fields(line);
+        if (!(fields >> word) || word[0] == '#') continue;   // blank or comment
+        string where = path + ":" + to_string(lineNo) + ": ";
+        if (!(fields >> pos) || (fields >> extra)) {
+            error = where + "expected: word PART_OF_SPEECH";
+            return false;
+        }
+        int token = partOfSpeech(pos);
+        if (token == UNKNOWN) {
+            error = where + "unknown part of speech " + pos;
+            return false;
+        }
+        if (!add(word, token, error)) {
+            error = where + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+int Vocabulary::lookup(const char* word, size_t length) const {
+    const Slot* s = find(word, length, hashWord(word, length));
+    return s ? (int)s->token : (int)UNKNOWN;
+}
+
+int lookupWord(const char* text, size_t length) {
+    return gVocabulary.lookup(text, length);
+}
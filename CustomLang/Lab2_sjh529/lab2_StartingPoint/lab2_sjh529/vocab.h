@@ -0,0 +1,94 @@
+#ifndef VOCAB_H
+#define VOCAB_H
+
+// ============================================================================
+// vocab.h - The lexicon: which word is which part of speech
+// ----------------------------------------------------------------------------
+// PURPOSE
+//   rules.l matches any word with one generic rule and asks the lexicon what
+//   the word is (lookupWord below). The words therefore live in data, not in
+//   the Flex regexes: a lexicon of 100k+ words does not make the scanner's
+//   DFA any bigger, and changing it needs no rebuild.
+//
+// WORD LIST FILE (./parse --vocab=FILE)
+//   One word and its part of speech per line; blank lines and lines that
+//   start with '#' are skipped:
+//       # word      part of speech
+//       the         ARTICLE
+//       my          POSSESSIVE
+//       green       ADJECTIVE
+//       dog         NOUN
+//       eats        VERB
+//       quickly     ADVERB
+//   A word must be one the lexer can match (WORD_RX in rules.l): ASCII
+//   letters, optionally joined by single ' or - ("don't", "mother-in-law");
+//   "x2", "café" or "end-" are reported as errors, with their line.
+//   Words and names are case-insensitive ("Dog" == "dog"). A word may be
+//   listed twice with the same part of speech, but not with two different
+//   ones: the lexer must return exactly one token per word.
+//   Without --vocab the built-in starter lexicon below is used (the words
+//   rules.l used to list); vocab.txt is an example list with a few more.
+//
+// HOW IT WORKS
+//   An open-addressing hash table. The words are stored lower-cased, one
+//   after the other, in a single character array; each table slot holds a
+//   word's hash, where it starts, its length and its token. A lookup hashes
+//   the lexeme while lower-casing it (no copy), then checks slots from the
+//   hash's home slot on until it finds the word or an empty slot. The table
+//   is kept at most half full, so that is one or two slots, and the cost
+//   does not grow with the size of the lexicon. A node-based unordered_map
+//   was 4x slower at 200k words (a cache miss per node); see vocab_bench.cpp.
+// ============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class Vocabulary {
+public:
+    // Replace the words with those of a word list file. On failure returns
+    // false with a message like "vocab.txt:12: unknown part of speech NUON".
+    bool load(const string& path, string& error);
+
+    // Replace the words with the built-in starter lexicon.
+    void loadBuiltin();
+
+    // Add one word; false (with a message) if the lexer could never match
+    // it or it already has another token.
+    bool add(const string& word, int token, string& error);
+
+    // The token of a word (ARTICLE ... ADVERB), or UNKNOWN.
+    int lookup(const char* word, size_t length) const;
+
+    size_t size() const { return count; }
+
+private:
+    struct Slot {
+        uint32_t hash;     // low bits of the word's hash
+        uint32_t offset;   // where the word starts in `text`
+        uint16_t length;   // 0 = empty slot
+        uint16_t token;
+    };
+
+    void clear();
+    void grow();
+    const Slot* find(const char* word, size_t length, uint64_t hash) const;
+
+    vector<Slot> slots;    // size is a power of two, at most half used
+    string text;           // all the words, lower-cased, back to back
+    size_t count = 0;
+};
+
+// The lexicon the lexer uses (set up in driver.cpp before parsing).
+extern Vocabulary gVocabulary;
+
+// Called by the word rule in rules.l: gVocabulary.lookup(yytext, yyleng).
+int lookupWord(const char* text, size_t length);
+
+// Token code for a part-of-speech name ("NOUN", "noun"), or UNKNOWN.
+int partOfSpeech(const string& name);
+
+#endif // VOCAB_H
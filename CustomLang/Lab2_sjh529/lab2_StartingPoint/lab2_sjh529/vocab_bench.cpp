@@ -0,0 +1,117 @@
+// ============================================================================
+// vocab_bench.cpp - How fast is the lexicon (vocab.h)?
+// ----------------------------------------------------------------------------
+// HOW TO RUN
+//   make vocab_bench
+//   ./vocab_bench                    // 200,000 made-up words, 10M lookups
+//   ./vocab_bench words.txt          // a real word list (see vocab.txt)
+//   ./vocab_bench words.txt 1000000  // ... and the number of lookups
+//
+// WHAT IT MEASURES
+//   1) Load time: reading and checking the word list (Vocabulary::load).
+//   2) Lookup time: lookups of words in random case, half of them in the
+//      list and half not (a sentence has both), against the big lexicon
+//      and against the 25 built-in starter words. The two per-lookup times
+//      should be close: a hash probe does not care how many words there are.
+// ============================================================================
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>    // remove
+#include <cstdlib>   // strtol
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "lexer.h"     // UNKNOWN
+#include "vocab.h"
+
+using namespace std;
+
+static const char* kNames[] = { "ARTICLE", "POSSESSIVE", "ADJECTIVE", "NOUN", "VERB", "ADVERB" };
+
+static string randomWord(mt19937& rng) {
+    string w(3 + rng() % 10, 'a');
+    for (char& c : w) c = (char)('a' + rng() % 26);
+    return w;
+}
+
+// Write `count` different made-up words with random parts of speech to `path`.
+static void writeWordList(const string& path, size_t count, mt19937& rng) {
+    ofstream out(path);
+    unordered_set<string> seen;
+    while (seen.size() < count) {
+        string w = randomWord(rng);
+        if (seen.insert(w).second) out << w << ' ' << kNames[rng() % 6] << '\n';
+    }
+}
+
+// The words of a word list (first field of each non-comment line).
+static vector<string> readWords(const string& path) {
+    vector<string> words;
+    ifstream in(path);
+    string word, rest;
+    while (in >> word) {
+        getline(in, rest);
+        if (word[0] != '#') words.push_back(word);
+    }
+    return words;
+}
+
+// Time `lookups` lookups cycling through `queries`; returns ns per lookup.
+static double timeLookups(const Vocabulary& v, const vector<string>& queries,
+                          long lookups, long& hits) {
+    hits = 0;
+    auto start = chrono::steady_clock::now();
+    for (long i = 0; i < lookups; ++i) {
+        const string& q = queries[i % queries.size()];
+        hits += v.lookup(q.data(), q.size()) != UNKNOWN;
+    }
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    return ns / lookups;
+}
+
+int main(int argc, char* argv[]) {
+    mt19937 rng(42);
+    string path = argc > 1 ? argv[1] : "vocab_bench_words.txt";
+    long lookups = argc > 2 ? strtol(argv[2], nullptr, 10) : 10000000;
+    if (argc <= 1) writeWordList(path, 200000, rng);
+    if (lookups <= 0) {
+        cerr << "Usage: " << argv[0] << " [WORDLIST] [LOOKUPS]\n";
+        return 1;
+    }
+
+    // 1) Load
+    Vocabulary big;
+    string error;
+    auto start = chrono::steady_clock::now();
+    if (!big.load(path, error)) {
+        cerr << error << "\n";
+        return 1;
+    }
+    double loadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "load:   " << big.size() << " words in " << loadMs << " ms ("
+         << (long)(big.size() / (loadMs / 1000)) << " words/s)\n";
+
+    // 2) Lookups: known words in random case, and made-up ones.
+    vector<string> words = readWords(path);
+    if (argc <= 1) remove(path.c_str());
+    vector<string> queries;
+    for (size_t i = 0; i < 1000000; ++i) {
+        string q = (i % 2 && !words.empty()) ? words[rng() % words.size()] : randomWord(rng);
+        for (char& c : q) if (rng() % 2) c = (char)toupper((unsigned char)c);
+        queries.push_back(q);
+    }
+    long hits = 0;
+    double ns = timeLookups(big, queries, lookups, hits);
+    cout << "lookup: " << lookups << " in " << big.size() << " words: " << ns
+         << " ns each (" << hits << " found)\n";
+
+    Vocabulary starter;
+    starter.loadBuiltin();
+    ns = timeLookups(starter, queries, lookups, hits);
+    cout << "lookup: " << lookups << " in " << starter.size() << " words: " << ns
+         << " ns each (" << hits << " found)\n";
+    return 0;
+}
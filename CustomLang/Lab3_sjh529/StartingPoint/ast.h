@@ -18,16 +18,113 @@
 #include <variant>
 #include <cassert>
 #include <cmath>
+#include <cstdio>
+#include <charconv>
+#include <string_view>
+#include "trace.h"
 using namespace std;
 using Value = variant<int, double>;
 
 // -----------------------------------------------------------------------------
 // Pretty printer
 // -----------------------------------------------------------------------------
-inline void ast_line(ostream &os, string prefix, bool last, string label)
+// Streams the tree into one large buffer that is written out in big blocks,
+// and keeps a single indentation string that nodes push onto and pop back.
+// Printing is linear in the size of the output however deep the tree is.
+// The same writer emits the compact JSON form (-j).
+class TreeWriter
 {
-  os << prefix << (last ? "└── " : "├── ") << label << "\n";
-}
+public:
+  explicit TreeWriter(ostream &os) : os(os) { buf.reserve(kFlushAt + 4096); }
+  ~TreeWriter() { flush(); }
+
+  // Start a tree line at the current indentation; finish it with '\n'
+  TreeWriter &line(bool last)
+  {
+    maybe_flush();
+    buf += indent;
+    buf += last ? "└── " : "├── ";
+    return *this;
+  }
+
+  TreeWriter &operator<<(string_view s)
+  {
+    buf.append(s.data(), s.size());
+    return *this;
+  }
+  TreeWriter &operator<<(char c)
+  {
+    buf += c;
+    return *this;
+  }
+  TreeWriter &operator<<(int v)
+  {
+    char tmp[16];
+    auto r = to_chars(tmp, tmp + sizeof tmp, v);
+    buf.append(tmp, r.ptr);
+    return *this;
+  }
+  TreeWriter &operator<<(double v)
+  {
+    buf += to_string(v); // same fixed format the tree has always used
+    return *this;
+  }
+
+  // JSON scalars
+  TreeWriter &json_string(string_view s)
+  {
+    buf += '"';
+    for (char c : s)
+    {
+      if (c == '"' || c == '\\')
+        (buf += '\\') += c;
+      else if (static_cast<unsigned char>(c) < 0x20)
+      {
+        char tmp[8];
+        snprintf(tmp, sizeof tmp, "\\u%04x", c);
+        buf += tmp;
+      }
+      else
+        buf += c;
+    }
+    buf += '"';
+    return *this;
+  }
+  TreeWriter &json_number(double v)
+  {
+    char tmp[32];
+    snprintf(tmp, sizeof tmp, "%.17g", v);
+    buf += tmp;
+    return *this;
+  }
+
+  // Indentation: push returns a mark that pop restores
+  size_t push(string_view s)
+  {
+    size_t mark = indent.size();
+    indent.append(s.data(), s.size());
+    return mark;
+  }
+  void pop(size_t mark) { indent.resize(mark); }
+  size_t mark() const { return indent.size(); }
+
+  void maybe_flush()
+  {
+    if (buf.size() >= kFlushAt)
+      flush();
+  }
+  void flush()
+  {
+    os.write(buf.data(), buf.size());
+    buf.clear();
+  }
+
+private:
+  static constexpr size_t kFlushAt = 1 << 20;
+  ostream &os;
+  string buf;
+  string indent;
+};
 
 // Symbol Table
 inline map<string, variant<int, double>> symbolTable;
@@ -44,6 +141,106 @@ inline int as_int_strict(const Value &v)
   return get<int>(v);
 }
 
+// -----------------------------------------------------------------------------
+// Tree node base
+// -----------------------------------------------------------------------------
+// Machine-generated TIPS can nest expressions and BEGIN/END blocks far deeper
+// than the native stack allows, so printing, evaluation and teardown all walk
+// the tree with explicit stacks. Each node only describes itself: print_node
+// prints its own lines, children lists its children with the indentation they
+// add, release_children hands them over so destructors never recurse.
+struct TreeNode
+{
+  using Children = vector<pair<TreeNode *, const char *>>;
+
+  virtual ~TreeNode() = default;
+  virtual const char *kind() const = 0;
+  virtual void print_node(TreeWriter &w) = 0;
+  virtual void json_fields(TreeWriter &w) { (void)w; } // ,"key":value pairs
+  virtual void children(Children &out) { (void)out; }
+  virtual void release_children(vector<unique_ptr<TreeNode>> &out) { (void)out; }
+};
+
+// Print a subtree below the writer's current indentation
+inline void print_subtree(TreeWriter &w, TreeNode *root)
+{
+  struct Frame
+  {
+    TreeNode *node;
+    size_t mark;        // parent's indentation
+    const char *indent; // what this child adds to it
+  };
+  size_t base = w.mark();
+  vector<Frame> stack{{root, base, ""}};
+  TreeNode::Children kids;
+  while (!stack.empty())
+  {
+    Frame f = stack.back();
+    stack.pop_back();
+    w.pop(f.mark);
+    w.push(f.indent);
+    f.node->print_node(w);
+    kids.clear();
+    f.node->children(kids);
+    size_t mark = w.mark();
+    for (auto it = kids.rbegin(); it != kids.rend(); ++it)
+      stack.push_back({it->first, mark, it->second});
+  }
+  w.pop(base);
+}
+
+// Emit a subtree as {"node":kind,...fields,"children":[...]}
+inline void json_subtree(TreeWriter &w, TreeNode *root)
+{
+  struct Item
+  {
+    TreeNode *node; // nullptr closes a children array
+    bool comma;
+  };
+  vector<Item> stack{{root, false}};
+  TreeNode::Children kids;
+  while (!stack.empty())
+  {
+    Item it = stack.back();
+    stack.pop_back();
+    if (!it.node)
+    {
+      w << "]}";
+      continue;
+    }
+    w.maybe_flush();
+    if (it.comma)
+      w << ',';
+    w << "{\"node\":";
+    w.json_string(it.node->kind());
+    it.node->json_fields(w);
+    kids.clear();
+    it.node->children(kids);
+    if (kids.empty())
+    {
+      w << '}';
+      continue;
+    }
+    w << ",\"children\":[";
+    stack.push_back({nullptr, false});
+    for (size_t i = kids.size(); i-- > 0;)
+      stack.push_back({kids[i].first, i > 0});
+  }
+}
+
+// Destroy a node's descendants one at a time; called from destructors
+inline void dismantle(TreeNode &root)
+{
+  vector<unique_ptr<TreeNode>> work;
+  root.release_children(work);
+  while (!work.empty())
+  {
+    unique_ptr<TreeNode> n = move(work.back());
+    work.pop_back();
+    n->release_children(work);
+  } // n is destroyed here, already childless
+}
+
 // Forward Declarations
 struct Write;
 struct Block;
@@ -58,26 +255,70 @@ struct Program;
 // TODO: Overload << for Program
 
 // PART 3
-struct ValueNode
+struct ValueNode : TreeNode
 {
-  virtual void print_tree(ostream &os, string prefix) = 0;
-  virtual Value interpret(ostream &out) = 0;
+  // Operands that must be evaluated before combine() (in evaluation order)
+  virtual size_t operand_count() { return 0; }
+  virtual ValueNode *operand(size_t i) { (void)i; return nullptr; }
+  // Produce this node's value from its already-evaluated operands
+  virtual Value combine(const Value *args, ostream &out) = 0;
+
+  // Interpret (defined below evaluate())
+  Value interpret(ostream &out);
 };
 
+// Evaluate an expression with an explicit stack (post-order over operands)
+inline Value evaluate(ValueNode *root, ostream &out)
+{
+  struct Frame
+  {
+    ValueNode *node;
+    size_t next;
+  };
+  vector<Frame> frames{{root, 0}};
+  vector<Value> values;
+  while (!frames.empty())
+  {
+    Frame &f = frames.back();
+    if (f.next < f.node->operand_count())
+    {
+      ValueNode *child = f.node->operand(f.next++);
+      frames.push_back({child, 0}); // f is invalid past this point
+      continue;
+    }
+    size_t n = f.node->operand_count();
+    Value v = f.node->combine(values.data() + values.size() - n, out);
+    values.resize(values.size() - n);
+    values.push_back(v);
+    frames.pop_back();
+  }
+  return values.back();
+}
+
+inline Value ValueNode::interpret(ostream &out)
+{
+  return evaluate(this, out);
+}
+
 struct IntLitNode : ValueNode
 {
   int v;
 
+  const char *kind() const { return "IntLit"; }
+
   // Print Tree
-  void print_tree(ostream &os, string prefix)
+  void print_node(TreeWriter &w)
   {
-    ast_line(os, prefix, true, "IntLitNode: " + to_string(v));
+    w.line(true) << "IntLitNode: " << v << '\n';
+  }
+  void json_fields(TreeWriter &w)
+  {
+    w << ",\"value\":" << v;
   }
 
   // Interpret
-  Value interpret(ostream &out)
+  Value combine(const Value *, ostream &)
   {
-    (void)out;
     // Provides other functions with v (when called with interpret)
     return v;
   }
@@ -87,16 +328,22 @@ struct RealLitNode : ValueNode
 {
   double v;
 
+  const char *kind() const { return "RealLit"; }
+
   // Print Tree
-  void print_tree(ostream &os, string prefix)
+  void print_node(TreeWriter &w)
   {
-    ast_line(os, prefix, true, "RealLitNode: " + to_string(v));
+    w.line(true) << "RealLitNode: " << v << '\n';
+  }
+  void json_fields(TreeWriter &w)
+  {
+    w << ",\"value\":";
+    w.json_number(v);
   }
 
   // Interpret
-  Value interpret(ostream &out)
+  Value combine(const Value *, ostream &)
   {
-    (void)out;
     // Provides other functions with v (when called with interpret)
     return v;
   }
@@ -106,14 +353,21 @@ struct IdentNode : ValueNode
 {
   string name;
 
+  const char *kind() const { return "Ident"; }
+
   // Print Tree
-  void print_tree(ostream &os, string prefix)
+  void print_node(TreeWriter &w)
   {
-    ast_line(os, prefix, true, "IdentNode: " + name);
+    w.line(true) << "IdentNode: " << name << '\n';
+  }
+  void json_fields(TreeWriter &w)
+  {
+    w << ",\"name\":";
+    w.json_string(name);
   }
 
   // Interpret
-  Value interpret(ostream &out)
+  Value combine(const Value *, ostream &)
   {
     // Reads symbolTable
     auto it = symbolTable.find(name); // Searches for the key
@@ -126,22 +380,44 @@ struct UnaryOp : ValueNode
   Token op;
   unique_ptr<ValueNode> sub;
 
+  ~UnaryOp() { dismantle(*this); }
+
+  const char *kind() const { return "Unary"; }
+
   // Print Tree
-  void print_tree(ostream &os, string prefix)
+  void print_node(TreeWriter &w)
   {
-    ast_line(os, prefix, false, "Unary");
-    ast_line(os, prefix + "|  ", false, "op: " + string(tokName(op)));
-    sub->print_tree(os, prefix + "  ");
+    w.line(false) << "Unary\n";
+    size_t mark = w.push("|  ");
+    w.line(false) << "op: " << tokName(op) << '\n';
+    w.pop(mark);
   }
+  void json_fields(TreeWriter &w)
+  {
+    w << ",\"op\":";
+    w.json_string(tokName(op));
+  }
+  void children(Children &out)
+  {
+    out.push_back({sub.get(), "  "});
+  }
+  void release_children(vector<unique_ptr<TreeNode>> &out)
+  {
+    if (sub)
+      out.push_back(move(sub));
+  }
+
+  // ++/-- work on the variable itself, only MINUS needs the operand's value
+  size_t operand_count() { return op == MINUS ? 1 : 0; }
+  ValueNode *operand(size_t) { return sub.get(); }
 
   // Interpret
-  Value interpret(ostream &out)
+  Value combine(const Value *args, ostream &)
   {
-    (void)out; // Out is intentionally unused throughout the interpret function
     // Check for MINUS
     if (op == MINUS)
     {
-      Value v = sub->interpret(out); //
+      const Value &v = args[0];
       if (holds_alternative<int>(v)) // Checks for v to be an int
         return -get<int>(v);         // Return the negative value of v if it is an int
     }
@@ -181,20 +457,41 @@ struct BinaryOp : ValueNode
   Token op;
   unique_ptr<ValueNode> left, right;
 
+  ~BinaryOp() { dismantle(*this); }
+
+  const char *kind() const { return "Binary"; }
+
   // Print Tree
-  void print_tree(ostream &os, string prefix)
+  void print_node(TreeWriter &w)
   {
-    ast_line(os, prefix, false, "Binary " + string(tokName(op)));
-    left->print_tree(os, prefix + "|  ");
-    right->print_tree(os, prefix + "  ");
+    w.line(false) << "Binary " << tokName(op) << '\n';
   }
+  void json_fields(TreeWriter &w)
+  {
+    w << ",\"op\":";
+    w.json_string(tokName(op));
+  }
+  void children(Children &out)
+  {
+    out.push_back({left.get(), "|  "});
+    out.push_back({right.get(), "  "});
+  }
+  void release_children(vector<unique_ptr<TreeNode>> &out)
+  {
+    if (left)
+      out.push_back(move(left));
+    if (right)
+      out.push_back(move(right));
+  }
+
+  size_t operand_count() { return 2; }
+  ValueNode *operand(size_t i) { return i == 0 ? left.get() : right.get(); }
 
   // Interpret
-  Value interpret(ostream &out)
+  Value combine(const Value *args, ostream &)
   {
-    (void)out;
-    Value a = left->interpret(out);
-    Value b = right->interpret(out);
+    const Value &a = args[0];
+    const Value &b = args[1];
 
     switch (op)
     {
@@ -258,11 +555,10 @@ struct BinaryOp : ValueNode
 };
 
 // PART 2
-struct Statement // Base clase for all statements
+struct Statement : TreeNode // Base clase for all statements
 {
   // Member Variables
   // Member Functions
-  virtual void print_tree(ostream &out, string prefix) = 0;
   virtual void interpret(ostream &) = 0;
 };
 
@@ -272,24 +568,45 @@ struct assignStmt : Statement // Update an existing variable's value
   string id;                 // key of the symbolTable
   unique_ptr<ValueNode> rhs; // Right hand side of the assign
 
+  ~assignStmt() { dismantle(*this); }
+
   // Member Functions
-  void print_tree(ostream &os, string prefix)
+  const char *kind() const { return "Assign"; }
+  void print_node(TreeWriter &w)
   {
-    ast_line(os, prefix, false, "Assign " + id + " :=");
-    rhs ? rhs->print_tree(os, prefix + "  ")
-        : ast_line(os, prefix + "  ", true, "(null expr)");
+    w.line(false) << "Assign " << id << " :=\n";
+    if (!rhs)
+    {
+      size_t mark = w.push("  ");
+      w.line(true) << "(null expr)\n";
+      w.pop(mark);
+    }
+  }
+  void json_fields(TreeWriter &w)
+  {
+    w << ",\"id\":";
+    w.json_string(id);
+  }
+  void children(Children &out)
+  {
+    if (rhs)
+      out.push_back({rhs.get(), "  "});
+  }
+  void release_children(vector<unique_ptr<TreeNode>> &out)
+  {
+    if (rhs)
+      out.push_back(move(rhs));
   }
 
   void interpret(ostream &out)
   {
-    (void)out;
     auto val = rhs->interpret(out);
     auto &slot = symbolTable[id];
 
-    if (auto p = get<int>(slot))
+    if (auto p = get_if<int>(&slot))
     {
       // Slot currently holds int -> assign an int
-      p = static_cast<int>(
+      *p = static_cast<int>(
           holds_alternative<int>(val)
               ? get<int>(val)
               : get<double>(val));
@@ -311,11 +628,17 @@ struct readStmt : Statement // Read input into a variable
   string target;
 
   // Member Functions
-  void print_tree(ostream &os, string prefix)
+  const char *kind() const { return "Read"; }
+  void print_node(TreeWriter &w)
   {
-    ast_line(os, prefix, true, "ReadStmt: " + target);
+    w.line(true) << "ReadStmt: " << target << '\n';
   }
-  void interpret(ostream &out)
+  void json_fields(TreeWriter &w)
+  {
+    w << ",\"target\":";
+    w.json_string(target);
+  }
+  void interpret(ostream &)
   {
     auto it = symbolTable.find(target);
     // if (it == symbolTable.end())
@@ -333,17 +656,23 @@ struct writeStmt : Statement // Outputs value or a string
   Token type;
 
   // Member Functions
-  void print_tree(ostream &os, string prefix)
+  const char *kind() const { return "Write"; }
+  void print_node(TreeWriter &w)
   {
     if (type == IDENT)
     {
-      ast_line(os, prefix, true, "writeStmt (IDENT): " + content);
+      w.line(true) << "writeStmt (IDENT): " << content << '\n';
     }
     else
     {
-      ast_line(os, prefix, true, "writeStmt (STRING): " + content);
+      w.line(true) << "writeStmt (STRING): " << content << '\n';
     }
   }
+  void json_fields(TreeWriter &w)
+  {
+    w << ",\"type\":" << (type == IDENT ? "\"IDENT\"" : "\"STRING\"") << ",\"content\":";
+    w.json_string(content);
+  }
   void interpret(ostream &out)
   {
     auto it = symbolTable.find(content);
@@ -365,17 +694,40 @@ struct compoundStmt : Statement // A sequence of statements
   // Member Variables
   vector<unique_ptr<Statement>> stmts;
 
+  ~compoundStmt() { dismantle(*this); }
+
   // Member Functions
-  void print_tree(ostream &os, string prefix) // Displays a "pretty" list of children
+  const char *kind() const { return "Compound"; }
+  void print_node(TreeWriter &) {} // Only a "pretty" list of children
+  void children(Children &out)
   {
+    // Statement prefixes are all spaces, so indenting after == before
     for (auto &s : stmts)
-      s->print_tree(os, "   " + prefix);
+      out.push_back({s.get(), "   "});
   }
-  void interpret(ostream &out) // For s in stmts: s->interpret(out)
+  void release_children(vector<unique_ptr<TreeNode>> &out)
   {
     for (auto &s : stmts)
+      out.push_back(move(s));
+    stmts.clear();
+  }
+  void interpret(ostream &out) // For s in stmts: s->interpret(out)
+  {
+    // Nested compounds are entered in place rather than by recursion
+    vector<pair<compoundStmt *, size_t>> stack{{this, 0}};
+    while (!stack.empty())
     {
-      s->interpret(out);
+      auto &[c, i] = stack.back();
+      if (i == c->stmts.size())
+      {
+        stack.pop_back();
+        continue;
+      }
+      Statement *s = c->stmts[i++].get();
+      if (auto *inner = dynamic_cast<compoundStmt *>(s))
+        stack.push_back({inner, 0});
+      else
+        s->interpret(out);
     }
   }
 };
@@ -384,27 +736,70 @@ struct Block
 {
   // Member Variables
   unique_ptr<compoundStmt> compound;
-  void print_tree(ostream &out)
+  void print_tree(TreeWriter &w)
   {
-    ast_line(out, "", true, "Block");
+    w.line(true) << "Block\n";
     if (!symbolTable.empty())
     {
-      ast_line(out, "  ", false, "Symbol Table:");
+      size_t mark = w.push("  ");
+      w.line(false) << "Symbol Table:\n";
+      w.pop(mark);
+      mark = w.push("   ");
       for (auto &[id, value] : symbolTable)
       {
         if (holds_alternative<int>(value)) // Check for int
-          ast_line(out, "   ", true, id + " := " + to_string(get<int>(value)));
+          w.line(true) << id << " := " << get<int>(value) << '\n';
         else
-          ast_line(out, "   ", true, id + " := " + to_string(get<double>(value)));
+          w.line(true) << id << " := " << get<double>(value) << '\n';
       }
+      w.pop(mark);
     }
     if (compound)
-      compound->print_tree(out, "  "); // Prints the tree for compound
+    {
+      size_t mark = w.push("  ");
+      print_subtree(w, compound.get()); // Prints the tree for compound
+      w.pop(mark);
+    }
   }
-  void interpret(ostream &out)
+  void print_json(TreeWriter &w)
   {
+    w << "{\"node\":\"Block\",\"symbols\":[";
+    bool first = true;
+    for (auto &[id, value] : symbolTable)
+    {
+      w << (first ? "{\"name\":" : ",{\"name\":");
+      w.json_string(id);
+      if (holds_alternative<int>(value))
+        w << ",\"type\":\"INTEGER\",\"value\":" << get<int>(value) << '}';
+      else
+      {
+        w << ",\"type\":\"REAL\",\"value\":";
+        w.json_number(get<double>(value));
+        w << '}';
+      }
+      first = false;
+    }
+    w << ']';
     if (compound)
-      compound->interpret(out);
+    {
+      w << ",\"children\":[";
+      json_subtree(w, compound.get());
+      w << ']';
+    }
+    w << '}';
+  }
+  void interpret(ostream &out)
+  {
+    if (!compound)
+      return;
+    // Top-level statements one at a time so each gets its own trace span
+    for (size_t i = 0; i < compound->stmts.size(); ++i)
+    {
+      Statement *s = compound->stmts[i].get();
+      trace::Span span(s->kind(), "interp");
+      span.arg("index", static_cast<long long>(i));
+      s->interpret(out);
+    }
   }
 };
 
@@ -414,15 +809,32 @@ struct Program
   unique_ptr<Block> block;
   void print_tree(ostream &os)
   {
-    cout << "Program\n";
-    ast_line(os, "", false, "name: " + name);
+    TreeWriter w(os);
+    w << "Program\n";
+    w.line(false) << "name: " << name << '\n';
     if (block)
-      block->print_tree(os);
+      block->print_tree(w);
     else
     {
-      ast_line(os, "", true, "Block");
-      ast_line(os, "    ", true, "(empty)");
+      w.line(true) << "Block\n";
+      size_t mark = w.push("    ");
+      w.line(true) << "(empty)\n";
+      w.pop(mark);
+    }
+  }
+  // Compact single-line JSON for tooling (-j)
+  void print_json(ostream &os)
+  {
+    TreeWriter w(os);
+    w << "{\"node\":\"Program\",\"name\":";
+    w.json_string(name);
+    if (block)
+    {
+      w << ",\"children\":[";
+      block->print_json(w);
+      w << ']';
     }
+    w << "}\n";
   }
   void interpret(ostream &out)
   {
@@ -436,4 +848,4 @@ struct Program
       p->print_tree(os);
     return os;
   }
-};
\ No newline at end of file
+};
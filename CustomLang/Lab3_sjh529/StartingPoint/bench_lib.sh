@@ -0,0 +1,47 @@
+#!/usr/bin/env bash
+# =============================================================================
+# bench_lib.sh — timing helpers shared by the *_bench.sh scripts (source it)
+# -----------------------------------------------------------------------------
+#   bench_tmpdir                 set TMP to a scratch directory removed on exit
+#   big_program STATEMENTS [D]   print a program of STATEMENTS assignment lines
+#                                nested D BEGIN/END levels deep (default 0)
+#   best_time RUNS CMD...        best wall seconds of RUNS runs of CMD, output
+#                                discarded
+#   mb_per_s BYTES SECONDS       throughput in MB/s
+# =============================================================================
+
+bench_tmpdir() {
+  TMP="$(mktemp -d)"
+  trap 'rm -rf "$TMP"' EXIT
+}
+
+big_program() {
+  local statements="$1" depth="${2:-0}"
+  printf 'PROGRAM BIG;\nVAR\n  X : INTEGER;\n  Y : REAL;\nBEGIN\n'
+  if ((depth > 0)); then
+    yes 'BEGIN ' | head -n "$depth" | tr -d '\n'; printf '\n'
+  fi
+  yes "X := (X + 1) * (2 - X) MOD 7; Y := Y ^^ 2.5 / (X - ++X);" | head -n "$statements"
+  printf "WRITE('done')\n"
+  if ((depth > 0)); then
+    yes ' END' | head -n "$depth" | tr -d '\n'; printf '\n'
+  fi
+  printf 'END\n'
+}
+
+best_time() {
+  local runs="$1" best="" start end t i
+  shift
+  for ((i = 0; i < runs; ++i)); do
+    start=$(date +%s.%N)
+    "$@" > /dev/null 2>&1
+    end=$(date +%s.%N)
+    t=$(awk -v s="$start" -v e="$end" 'BEGIN { print e - s }')
+    if [[ -z "$best" ]] || awk -v a="$t" -v b="$best" 'BEGIN { exit !(a < b) }'; then best="$t"; fi
+  done
+  echo "$best"
+}
+
+mb_per_s() {
+  awk -v b="$1" -v t="$2" 'BEGIN { printf "%.2f", b / t / 1e6 }'
+}
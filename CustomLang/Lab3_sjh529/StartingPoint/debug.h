@@ -28,14 +28,19 @@
 //    • These calls become no-ops when debugging is off, so you can leave them in.
 //    • Prefer dbg::line() for whole messages; use dbg::log() to build a line
 //      across multiple calls.
-//    • If you need compile-time removal of debug code, use macros and #ifdef;
-//      this header is intentionally runtime-toggleable for teaching.
+//    • dbg::line() still evaluates its argument: a message built with
+//      string + ... allocates even when debugging is off. In hot paths use
+//      DBG_LINE(a, b, c) (streams the pieces only when on) or
+//      dbg::lazy([&]{ return ...; }) (calls the lambda only when on).
+//    • Building with -DTIPS_NO_TRACE compiles DBG_LINE/DBG_LOG/dbg::lazy away
+//      entirely (see the parse-notrace target in the makefile).
 //
 // ============================================================================
 
 #pragma once
 #include <iostream>
 #include <atomic>
+#include <utility>
 
 namespace dbg {
 
@@ -67,4 +72,35 @@ namespace dbg {
     if (enabled().load(std::memory_order_relaxed)) std::cerr << x << '\n';
   }
 
+#ifdef TIPS_NO_TRACE
+  /// Tracing compiled out: the condition is a constant the optimizer folds.
+  inline constexpr bool on() { return false; }
+#else
+  inline bool on() { return enabled().load(std::memory_order_relaxed); }
+#endif
+
+  /// Stream every piece to std::cerr with no temporaries. Callers check on().
+  template<class... Ts>
+  inline void write(const Ts&... xs) {
+    (std::cerr << ... << xs);
+  }
+
+  /// Print the string produced by make() only if debugging is on; make() is
+  /// never called otherwise, so building the message costs nothing.
+  template<class F>
+  inline void lazy(F&& make) {
+    if (on()) std::cerr << std::forward<F>(make)() << '\n';
+  }
+
 } // namespace dbg
+
+/// Hot-path trace: DBG_LINE("peek: ", name, " @ line ", n). The arguments are
+/// not evaluated unless debugging is on, and not compiled at all under
+/// TIPS_NO_TRACE. DBG_LOG is the same without the trailing newline.
+#ifdef TIPS_NO_TRACE
+#define DBG_LINE(...) ((void)0)
+#define DBG_LOG(...)  ((void)0)
+#else
+#define DBG_LINE(...) do { if (dbg::on()) dbg::write(__VA_ARGS__, '\n'); } while (0)
+#define DBG_LOG(...)  do { if (dbg::on()) dbg::write(__VA_ARGS__); } while (0)
+#endif
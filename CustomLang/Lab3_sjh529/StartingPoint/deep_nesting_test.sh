@@ -0,0 +1,70 @@
+#!/usr/bin/env bash
+# =============================================================================
+# deep_nesting_test.sh — stress the parser/interpreter with very deep nesting
+# -----------------------------------------------------------------------------
+# Generates machine-style TIPS programs nested DEPTH levels deep (default 10^6)
+# and runs them with a deliberately small native stack. Parsing, evaluation,
+# printing and teardown are all iterative, so none of these may crash.
+#
+# Usage: ./deep_nesting_test.sh [DEPTH]      (PARSE_BIN overrides ./parse)
+# =============================================================================
+set -u
+
+PARSE_BIN="${PARSE_BIN:-./parse}"
+DEPTH="${1:-1000000}"
+PRINT_DEPTH=2000          # -p output grows with depth^2, keep this one small
+STACK_KB=1024             # well below the 8 MB default
+
+BOLD=$'\e[1m'; RESET=$'\e[0m'; RED=$'\e[31m'; GREEN=$'\e[32m'; CYAN=$'\e[36m'
+OK="${GREEN}✔${RESET}"; FAIL="${RED}✘${RESET}"
+
+if [[ ! -x "$PARSE_BIN" ]]; then
+  echo "${RED}Error:${RESET} PARSE_BIN not found or not executable: $PARSE_BIN"
+  exit 2
+fi
+
+TMP="$(mktemp -d)"; trap 'rm -rf "$TMP"' EXIT
+
+# repeat STRING COUNT — STRING repeated COUNT times, no newline
+repeat() { yes "$1" | head -n "$2" | tr -d '\n'; }
+
+# program NAME EXPR — single assignment to X, then WRITE(X)
+program() {
+  printf 'PROGRAM %s;\nVAR\n  X : INTEGER;\nBEGIN\n  X := ' "$1"
+  cat
+  printf ';\n  WRITE(X)\nEND\n'
+}
+
+gen_parens()   { { repeat '(' "$1"; printf '7'; repeat ')' "$1"; } | program PARENS; }
+gen_chain()    { { repeat '1+(' "$1"; printf '0'; repeat ')' "$1"; } | program CHAIN; }
+gen_compound() {
+  printf 'PROGRAM NEST;\nBEGIN\n'
+  repeat 'BEGIN ' "$1"; printf "WRITE('bottom')"; repeat ' END' "$1"
+  printf '\nEND\n'
+}
+
+fail=0
+# run_case NAME FILE EXPECTED_LINE [FLAGS...]
+run_case() {
+  local name="$1" file="$2" want="$3"; shift 3
+  local out rc
+  out="$( (ulimit -s "$STACK_KB"; "$PARSE_BIN" "$@" "$file") 2>&1 )"; rc=$?
+  if [[ $rc -eq 0 ]] && grep -qx -- "$want" <<<"$out"; then
+    echo "  ${OK} ${name}"
+  else
+    echo "  ${FAIL} ${name} (rc=$rc)"; tail -n 5 <<<"$out"; fail=1
+  fi
+}
+
+echo "${BOLD}${CYAN}TIPS deep nesting${RESET}  depth=${DEPTH}  stack=${STACK_KB}KB"
+gen_parens   "$DEPTH"       > "$TMP/parens.tips"
+gen_chain    "$DEPTH"       > "$TMP/chain.tips"
+gen_compound "$DEPTH"       > "$TMP/compound.tips"
+gen_chain    "$PRINT_DEPTH" > "$TMP/print.tips"
+
+run_case "nested parentheses"       "$TMP/parens.tips"   "7"
+run_case "right-deep 1+(1+(...))"   "$TMP/chain.tips"    "$DEPTH"
+run_case "nested BEGIN ... END"     "$TMP/compound.tips" "'bottom'"
+run_case "-p on depth $PRINT_DEPTH" "$TMP/print.tips"    "$PRINT_DEPTH" -p
+
+exit $fail
@@ -9,7 +9,7 @@
 // A small driver that wires together the classic compiler phases
 // used in this course project:
 //   (1) Lexing  - optional token dump (-t)
-//   (2) Parsing - optional AST print (-p)
+//   (2) Parsing - optional AST print (-p) or JSON AST dump (-j)
 //   (3) Interpreting the parsed Program
 //   (4) Optional symbol table printing (-s) [Part 2]
 //
@@ -22,10 +22,10 @@
 //       name : TYPE = value
 //       counter : INTEGER = 42
 //
-// TODO [Part 4]:
-//   - Validate --skin=NAME against a known list from the scanner (e.g. default,
-//     INITIAL, pirate, cat). If unknown, show suggestions.
-//   - Consider a --list-skins flag that queries the scanner for available skins.
+// Skins [Part 4]:
+//   --skin=NAME is validated against the scanner's skin table (keywords.h);
+//   unknown names list the available skins. --list-skins prints each skin's
+//   keywords.
 // =============================================================================
 #include <cstdio>
 #include <cstring>
@@ -35,6 +35,8 @@
 #include "lexer.h"  // Scanner functions: yylex, yyin, yylineno, yytext, tokName()
 #include "debug.h"  // Debug flag support: dbg::set(bool)
 #include "ast.h"    // Program AST type with interpret() and print_symbols()
+#include "trace.h"  // --trace=FILE: Chrome trace-event spans per phase
+#include "keywords.h" // Skin table shared with the scanner
 using namespace std;
 // -----------------------------------------------------------------------------
 // Scanner Skin Bridge
@@ -54,6 +56,7 @@ unique_ptr<Program> parseProgram();
 // Command-line flags
 // -----------------------------------------------------------------------------
 bool FLAG_TOKENS=false, FLAG_PRINT_AST=false, FLAG_SYMBOLS=false; // -t, -p, -s
+bool FLAG_JSON_AST=false;                                          // -j
 
 // -----------------------------------------------------------------------------
 // ANSI color codes for nicer output 
@@ -77,14 +80,32 @@ void usage(const char* prog)
     cout << "Usage: " << prog << " [options] [file]\n"
          << "Options:\n"
          << "  -p            Print AST after parse\n"
+         << "  -j            Print AST as compact JSON and exit\n"
          << "  -t            Tokenize only (dump tokens) and exit\n"
          << "  -s            Print symbol table after interpretation\n"
          << "  -d            Enable debug traces to stderr\n"
+         << "  --trace=FILE  Write phase timings as Chrome trace-event JSON\n"
          << "  --skin=NAME   Select keyword skin (default, INITIAL, pirate, cat)\n"
+         << "  --list-skins  List keyword skins and exit\n"
          << "  --help        Show this help\n\n"
          << "Example: " << prog << " --skin=pirate samples/hello.tips -p\n";
 }
 
+// -----------------------------------------------------------------------------
+// Skin listing for --list-skins
+// -----------------------------------------------------------------------------
+void listSkins()
+{
+    banner("KEYWORD SKINS", C_CYAN);
+    for (const Skin& s : kSkins)
+    {
+        cout << s.name << " (" << s.blurb << ")\n ";
+        for (size_t i = 0; i < s.count; ++i)
+            cout << " " << tokName(s.words[i].tok) << "=" << s.words[i].word;
+        cout << "\n";
+    }
+}
+
 // -----------------------------------------------------------------------------
 // Token dump routine for -t mode
 // -----------------------------------------------------------------------------
@@ -94,10 +115,15 @@ void usage(const char* prog)
 // -----------------------------------------------------------------------------
 int dumpTokens()
 {
+    trace::Span span("tokenize", "phase");
     banner("BEGIN TOKENIZE", C_YBOLD);
     while (true)
     {
-        int t = yylex();
+        int t;
+        {
+            trace::Lex lex;
+            t = yylex();
+        }
         if (t == 0) t = TOK_EOF;
         cout << yylineno << " " << tokName(t);
         if (t == IDENT || t == STRINGLIT)
@@ -129,14 +155,24 @@ int main(int argc, char** argv)
     {
         const char* a = argv[i];
         if (!strcmp(a, "-p")) FLAG_PRINT_AST = true;
+        else if (!strcmp(a, "-j")) FLAG_JSON_AST = true;
         else if (!strcmp(a, "-t")) FLAG_TOKENS = true;
         else if (!strcmp(a, "-s")) FLAG_SYMBOLS = true;
         else if (!strcmp(a, "-d")) dbg::set(true);
-        else if (!strncmp(a, "--skin=", 8))
+        else if (!strncmp(a, "--trace=", 8)) trace::start(a + 8);
+        else if (!strncmp(a, "--skin=", 7))
         {
-            gSkinStorage = string(a + 8);
+            if (!findSkin(a + 7))
+            {
+                cerr << "Unknown skin: " << (a + 7) << "\nAvailable skins:";
+                for (const Skin& s : kSkins) cerr << " " << s.name;
+                cerr << "\n";
+                return 1;
+            }
+            gSkinStorage = string(a + 7);
             gSkinC = gSkinStorage.c_str();
         }
+        else if (!strcmp(a, "--list-skins")) { listSkins(); return 0; }
         else if (!strcmp(a, "--help")) { usage(argv[0]); return 0; }
         else if (a[0] == '-') { cerr << "Unknown option: " << a << "\n"; return 1; }
         else if (!infile) infile = a;
@@ -161,15 +197,36 @@ int main(int argc, char** argv)
 
         // Parse
         if (FLAG_PRINT_AST) banner("BEGIN PARSING", C_MBOLD);
-        unique_ptr<Program> root = parseProgram();
+        unique_ptr<Program> root;
+        {
+            trace::Span span("parse", "phase");
+            root = parseProgram();
+        }
+
+        // Mode: JSON AST only (no banners, nothing interpreted)
+        if (FLAG_JSON_AST)
+        {
+            trace::Span span("print JSON AST", "phase");
+            root->print_json(cout);
+            if (in && in!=stdin) fclose(in);
+            return 0;
+        }
+
         // operator<<(ostream&, Program*) must be defined in ast.h
-        if (FLAG_PRINT_AST) cout << root;
+        if (FLAG_PRINT_AST)
+        {
+            trace::Span span("print AST", "phase");
+            cout << root;
+        }
         if (FLAG_PRINT_AST) banner("PARSING COMPLETE", C_MBOLD);
 
         // Interpret
         banner("BEGIN INTERPRETATION", C_YBOLD);
         // WRITE statements should print to stdout by spec
-        root->interpret(cout);
+        {
+            trace::Span span("interpret", "phase");
+            root->interpret(cout);
+        }
         banner("INTERPRETATION COMPLETE", C_YBOLD);
 
 
@@ -0,0 +1,162 @@
+// *****************************************************************************
+//   keywords.h - Keyword skins with compile-time perfect hashing
+// *****************************************************************************
+// MSU CSE 4714/6714 Capstone Project (Fall 2025)
+//
+// The scanner matches every word with one generic rule and calls
+// classifyWord(), which looks the lexeme up in the active skin's table.
+// Adding a skin is a new word list plus one kSkins entry: the flex DFA
+// does not grow and nothing needs to be regenerated.
+//
+// Each table is a perfect hash built at compile time: buildTable() searches
+// for a seed under which every keyword of the skin lands in its own slot.
+// Lookup is a single hash over the lexeme and at most one compare.
+//
+// The skin is chosen with --skin=NAME; the driver publishes the name in
+// gSkinC and activeSkin() re-resolves it whenever that pointer changes.
+// *****************************************************************************
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include "lexer.h"
+
+struct Keyword
+{
+  const char *word;
+  Token tok;
+};
+
+// -----------------------------------------------------------------------------
+// Word lists (same order in every skin: PROGRAM BEGIN END WRITE VAR INTEGER
+// REAL READ MOD). Words must match the identifier rule: [A-Z][A-Z0-9]*
+// -----------------------------------------------------------------------------
+inline constexpr Keyword kDefaultWords[] = {
+    {"PROGRAM", PROGRAM}, {"BEGIN", TOK_BEGIN}, {"END", END},
+    {"WRITE", WRITE},     {"VAR", VAR},         {"INTEGER", INTEGER},
+    {"REAL", REAL},       {"READ", READ},       {"MOD", MOD}};
+
+inline constexpr Keyword kPirateWords[] = {
+    {"VOYAGE", PROGRAM}, {"AHOY", TOK_BEGIN},  {"AVAST", END},
+    {"SQUAWK", WRITE},   {"CARGO", VAR},       {"DOUBLOON", INTEGER},
+    {"PIECES", REAL},    {"SPYGLASS", READ},   {"SCUTTLE", MOD}};
+
+inline constexpr Keyword kCatWords[] = {
+    {"KITTY", PROGRAM}, {"PURR", TOK_BEGIN},    {"HISS", END},
+    {"MEOW", WRITE},    {"TOYS", VAR},          {"WHISKERS", INTEGER},
+    {"CATNIP", REAL},   {"SNIFF", READ},        {"SCRATCH", MOD}};
+
+// -----------------------------------------------------------------------------
+// Perfect hash construction
+// -----------------------------------------------------------------------------
+constexpr size_t kwLength(const char *s)
+{
+  size_t n = 0;
+  while (s[n])
+    ++n;
+  return n;
+}
+
+constexpr uint32_t kwHash(const char *s, size_t n, uint32_t seed)
+{
+  uint32_t h = seed ^ static_cast<uint32_t>(n) * 0x9E3779B1u;
+  for (size_t i = 0; i < n; ++i)
+  {
+    h ^= static_cast<unsigned char>(s[i]);
+    h *= 16777619u; // FNV prime
+  }
+  return h ^ (h >> 15);
+}
+
+constexpr size_t kKeywordSlots = 32; // power of two, >= 2x the largest skin
+
+struct KeywordTable
+{
+  uint32_t seed = 0;
+  signed char slot[kKeywordSlots] = {}; // index into the word list, or -1
+};
+
+template <size_t N>
+constexpr KeywordTable buildTable(const Keyword (&words)[N])
+{
+  static_assert(2 * N <= kKeywordSlots, "raise kKeywordSlots");
+  for (uint32_t seed = 1;; ++seed)
+  {
+    KeywordTable t;
+    t.seed = seed;
+    for (auto &s : t.slot)
+      s = -1;
+    bool ok = true;
+    for (size_t i = 0; i < N && ok; ++i)
+    {
+      size_t at = kwHash(words[i].word, kwLength(words[i].word), seed) & (kKeywordSlots - 1);
+      ok = t.slot[at] < 0;
+      t.slot[at] = static_cast<signed char>(i);
+    }
+    if (ok)
+      return t;
+  }
+}
+
+inline constexpr KeywordTable kDefaultTable = buildTable(kDefaultWords);
+inline constexpr KeywordTable kPirateTable = buildTable(kPirateWords);
+inline constexpr KeywordTable kCatTable = buildTable(kCatWords);
+
+// -----------------------------------------------------------------------------
+// Skins
+// -----------------------------------------------------------------------------
+struct Skin
+{
+  const char *name;
+  const char *blurb;
+  const Keyword *words;
+  size_t count;
+  const KeywordTable *table;
+};
+
+inline constexpr Skin kSkins[] = {
+    {"default", "English keywords", kDefaultWords, std::size(kDefaultWords), &kDefaultTable},
+    {"INITIAL", "alias for default", kDefaultWords, std::size(kDefaultWords), &kDefaultTable},
+    {"pirate", "arr, matey", kPirateWords, std::size(kPirateWords), &kPirateTable},
+    {"cat", "for programmers who knock things off tables", kCatWords, std::size(kCatWords), &kCatTable},
+};
+
+inline const Skin *findSkin(const char *name)
+{
+  for (const Skin &s : kSkins)
+    if (!strcmp(s.name, name))
+      return &s;
+  return nullptr;
+}
+
+// Published by the driver (--skin=NAME)
+extern "C" const char *gSkinC;
+
+// The skin named by gSkinC; unknown names fall back to default
+inline const Skin &activeSkin()
+{
+  static const char *resolvedFor = nullptr;
+  static const Skin *skin = &kSkins[0];
+  if (gSkinC != resolvedFor)
+  {
+    resolvedFor = gSkinC;
+    const Skin *s = gSkinC ? findSkin(gSkinC) : nullptr;
+    skin = s ? s : &kSkins[0];
+  }
+  return *skin;
+}
+
+// Keyword in the active skin, else IDENT (1-8 chars) or UNKNOWN (longer)
+inline Token classifyWord(const char *text, size_t len)
+{
+  const Skin &skin = activeSkin();
+  int i = skin.table->slot[kwHash(text, len, skin.table->seed) & (kKeywordSlots - 1)];
+  if (i >= 0)
+  {
+    const Keyword &k = skin.words[i];
+    if (!strncmp(k.word, text, len) && k.word[len] == '\0')
+      return k.tok;
+  }
+  return len <= 8 ? IDENT : UNKNOWN;
+}
@@ -10,9 +10,11 @@
 #include <sstream>
 #include <string>
 #include <set>
+#include <vector>
 #include "lexer.h"
 #include "ast.h"
 #include "debug.h"
+#include "trace.h"
 using namespace std;
 
 // Forward Declarations
@@ -24,10 +26,8 @@ unique_ptr<compoundStmt> parseCompound();
 unique_ptr<Statement> parseStatement();
 unique_ptr<Statement> parseRead();
 unique_ptr<Statement> parseAssign();
-unique_ptr<ValueNode> parseTerm();
 unique_ptr<ValueNode> parsePrimary();
 unique_ptr<ValueNode> parseValue();
-unique_ptr<ValueNode> parseFactor();
 
 // -----------------------------------------------------------------------------
 // One-token lookahead
@@ -42,7 +42,10 @@ Token peek()
 {
   if (!havePeek)
   {
-    peekTok = yylex();
+    {
+      trace::Lex lex;
+      peekTok = yylex();
+    }
     if (peekTok == 0)
     {
       peekTok = TOK_EOF;
@@ -50,9 +53,10 @@ Token peek()
     }
     else
     {
-      peekLex = yytext ? string(yytext) : string();
+      peekLex.assign(yytext ? yytext : ""); // reuses peekLex's capacity
     }
-    dbg::line(string("peek: ") + tname(peekTok) + (peekLex.empty() ? "" : " [" + peekLex + "]") + " @ line " + to_string(yylineno));
+    DBG_LINE("peek: ", tname(peekTok), peekLex.empty() ? "" : " [", peekLex,
+             peekLex.empty() ? "" : "]", " @ line ", yylineno);
     havePeek = true;
   }
   return peekTok;
@@ -60,7 +64,7 @@ Token peek()
 Token nextTok()
 {
   Token t = peek();
-  dbg::line(string("consume: ") + tname(t));
+  DBG_LINE("consume: ", tname(t));
   havePeek = false;
   return t;
 }
@@ -69,7 +73,7 @@ Token expect(Token want, const char *msg)
   Token got = nextTok();
   if (got != want)
   {
-    dbg::line(string("expect FAIL: wanted ") + tname(want) + ", got " + tname(got));
+    DBG_LINE("expect FAIL: wanted ", tname(want), ", got ", tname(got));
     ostringstream oss;
     oss << "Parse error (line " << yylineno << "): expected "
         << tname(want) << " — " << msg << ", got " << tname(got)
@@ -86,6 +90,7 @@ Token expect(Token want, const char *msg)
 // -----------------------------------------------------------------------------
 unique_ptr<Program> parseProgram()
 {
+  trace::Span span("parseProgram", "parse");
   expect(PROGRAM, "start of program");
   expect(IDENT, "program name");
   string nameLex = peekLex;
@@ -101,6 +106,7 @@ unique_ptr<Program> parseProgram()
 
 unique_ptr<Block> parseBlock()
 {
+  trace::Span span("parseBlock", "parse");
   auto node = make_unique<Block>();
   if (peek() == VAR)
   {
@@ -134,8 +140,10 @@ unique_ptr<Statement> parseWrite()
 
 void parseDeclaration()
 {
+  trace::Span span("parseDeclaration", "parse");
   expect(IDENT, "parseDeclaration: Expected an Identifier");
   string idLex = peekLex;
+  span.arg("id", idLex);
   expect(COLON, "parseDeclaration: Expected a Colon after after Identifier");
   Token Type = peek();
   if (Type != INTEGER && Type != REAL)
@@ -159,22 +167,49 @@ void parseDeclaration()
   }
 }
 
+// compound -> BEGIN statement { ; statement } END
+// Nested BEGIN ... END blocks are tracked on an explicit stack of open
+// compounds instead of recursing through parseStatement().
 unique_ptr<compoundStmt> parseCompound()
 {
+  trace::Span span("parseCompound", "parse");
   expect(TOK_BEGIN, "parseCompound: Expected a Begin Token");
-  auto buff = make_unique<compoundStmt>();
-  buff->stmts.push_back(parseStatement());
-  while (peek() == SEMICOLON)
+  auto root = make_unique<compoundStmt>();
+  vector<compoundStmt *> open{root.get()};
+  bool needStmt = true;
+  while (true)
   {
-    expect(SEMICOLON, "parseCompound: Expected a semicolon");
-    if (peek() == END)
+    if (needStmt)
+    {
+      if (peek() == TOK_BEGIN)
+      {
+        expect(TOK_BEGIN, "parseCompound: Expected a Begin Token");
+        auto inner = make_unique<compoundStmt>();
+        compoundStmt *innerPtr = inner.get();
+        open.back()->stmts.push_back(move(inner));
+        open.push_back(innerPtr);
+        continue;
+      }
+      open.back()->stmts.push_back(parseStatement());
+      needStmt = false;
+    }
+    if (peek() == SEMICOLON)
+    {
+      expect(SEMICOLON, "parseCompound: Expected a semicolon");
+      if (peek() != END)
+      {
+        needStmt = true;
+        continue;
+      }
+    }
+    expect(END, "parseCompound: Expected an End Token");
+    open.pop_back();
+    if (open.empty())
     {
-      break;
+      span.arg("statements", static_cast<long long>(root->stmts.size()));
+      return root;
     }
-    buff->stmts.push_back(parseStatement());
   }
-  expect(END, "parseCompound: Expected an End Token");
-  return buff;
 }
 
 unique_ptr<Statement> parseStatement()
@@ -194,34 +229,121 @@ unique_ptr<Statement> parseStatement()
   }
 }
 
-// value -> term { (+/-) term }
+// -----------------------------------------------------------------------------
+// Expressions
+// -----------------------------------------------------------------------------
+//   value   -> term { (+|-) term }
+//   term    -> factor { (*|/|MOD|^^) factor }
+//   factor  -> [ ++ | -- ] primary
+//   primary -> FLOATLIT | INTLIT | IDENT | ( value )
+// Parsed with explicit operand/operator stacks (shunting-yard) so that deeply
+// nested parentheses cost heap, not native stack. All binary operators are
+// left-associative, which matches the loops of the grammar above.
+// -----------------------------------------------------------------------------
+static int precedence(Token t)
+{
+  switch (t)
+  {
+  case PLUS:
+  case MINUS:
+    return 1;
+  case MULTIPLY:
+  case DIVIDE:
+  case MOD:
+  case CUSTOM_OPER:
+    return 2;
+  default:
+    return 0; // OPENPAREN, ++, -- markers: never reduced by precedence
+  }
+}
+
+// Pop the top operator and combine it with its operand(s)
+static void reduce(vector<unique_ptr<ValueNode>> &operands, vector<Token> &ops)
+{
+  Token op = ops.back();
+  ops.pop_back();
+  if (op == INCREMENT || op == DECREMENT)
+  {
+    auto un = make_unique<UnaryOp>();
+    un->op = op;
+    un->sub = move(operands.back());
+    operands.back() = move(un);
+    return;
+  }
+  auto bin = make_unique<BinaryOp>();
+  bin->op = op;
+  bin->right = move(operands.back());
+  operands.pop_back();
+  bin->left = move(operands.back());
+  operands.back() = move(bin);
+}
+
+// A primary just completed: apply the ++/-- prefixes waiting on it
+static void reducePrefixes(vector<unique_ptr<ValueNode>> &operands, vector<Token> &ops)
+{
+  while (!ops.empty() && (ops.back() == INCREMENT || ops.back() == DECREMENT))
+    reduce(operands, ops);
+}
+
 unique_ptr<ValueNode> parseValue()
 {
-  auto node = parseTerm();
+  vector<unique_ptr<ValueNode>> operands;
+  vector<Token> ops;
+  size_t openParens = 0;
+  bool afterPrefix = false; // factor allows one ++/-- before its primary
+
   while (true)
   {
+    // Expecting a factor
     Token t = peek();
-    if (t == PLUS || t == MINUS)
+    if ((t == INCREMENT || t == DECREMENT) && !afterPrefix)
+    {
+      expect(t, "parseFactor: Expected an increment or decrement");
+      ops.push_back(t);
+      afterPrefix = true;
+      continue;
+    }
+    afterPrefix = false;
+    if (t == OPENPAREN)
     {
-      Token op = t;
-      expect(t, "additive operator (+/-) in value");
-      auto rhs = parseTerm();
+      expect(OPENPAREN, "parsePrimary: Expected an OPENPAREN");
+      ops.push_back(OPENPAREN);
+      ++openParens;
+      continue;
+    }
+    operands.push_back(parsePrimary());
+    reducePrefixes(operands, ops);
 
-      auto bin = make_unique<BinaryOp>();
-      bin->op = op;
-      bin->left = move(node);
-      bin->right = move(rhs);
-      node = move(bin);
+    // Expecting an operator, a CLOSEPAREN, or the end of the value
+    t = peek();
+    while (openParens > 0 && t == CLOSEPAREN)
+    {
+      expect(CLOSEPAREN, "parsePrimary: Expected a CLOSEPAREN");
+      while (ops.back() != OPENPAREN)
+        reduce(operands, ops);
+      ops.pop_back();
+      --openParens;
+      reducePrefixes(operands, ops);
+      t = peek();
     }
-    else
+    int prec = precedence(t);
+    if (prec == 0)
     {
-      break;
+      while (!ops.empty() && ops.back() != OPENPAREN)
+        reduce(operands, ops);
+      if (openParens > 0)
+        expect(CLOSEPAREN, "parsePrimary: Expected a CLOSEPAREN"); // throws
+      return move(operands.back());
     }
+    while (!ops.empty() && precedence(ops.back()) >= prec)
+      reduce(operands, ops);
+    expect(t, prec == 1 ? "additive operator (+/-) in value"
+                        : "parseTerm: Expected multiple, divide, mod, or exponential");
+    ops.push_back(t);
   }
-  return node;
 }
 
-// primary -> FLOATLIT | INTLIT | IDENT | ( value )
+// primary -> FLOATLIT | INTLIT | IDENT   ('(' value ')' is handled by parseValue)
 unique_ptr<ValueNode> parsePrimary()
 {
   Token type = peek();
@@ -251,62 +373,11 @@ unique_ptr<ValueNode> parsePrimary()
     bin3->name = nameLex;
     return bin3;
   }
-  case OPENPAREN:
-  {
-    expect(OPENPAREN, "parsePrimary: Expected an OPENPAREN");
-    auto node = parseValue();
-    expect(CLOSEPAREN, "parsePrimary: Expected a CLOSEPAREN");
-    return node;
-  }
   default:
     throw runtime_error("parsePrimary: Invalid Token");
   }
 }
 
-// term -> factor { (*|/|MOD|^^) factor }
-unique_ptr<ValueNode> parseTerm()
-{
-  auto node = parseFactor();
-  while (true)
-  {
-    Token t = peek();
-    if (t == MULTIPLY || t == DIVIDE || t == MOD || t == CUSTOM_OPER)
-    {
-      Token op = t;
-      expect(t, "parseTerm: Expected multiple, divide, mod, or exponential");
-      auto rhs = parseFactor();
-
-      auto bin = make_unique<BinaryOp>();
-      bin->op = op;
-      bin->left = move(node);
-      bin->right = move(rhs);
-      node = move(bin);
-    }
-    else
-    {
-      break;
-    }
-  }
-  return node;
-}
-
-// factor -> [ ++ | -- | ] primary | primary
-unique_ptr<ValueNode> parseFactor()
-{
-  Token type = peek();
-  if (type == INCREMENT || type == DECREMENT)
-  {
-    expect(type, "parseFactor: Expected an increment or decrement");
-    auto node = parsePrimary();
-    auto bin = make_unique<UnaryOp>();
-    bin->op = type;
-    bin->sub = move(node);
-    node = move(bin);
-    return bin;
-  }
-  return parsePrimary();
-}
-
 unique_ptr<Statement> parseRead()
 {
   expect(READ, "parseRead: Expected Read");
@@ -0,0 +1,36 @@
+#!/usr/bin/env bash
+# =============================================================================
+# print_bench.sh — time AST printing (-p) and JSON dumping (-j) on large trees
+# -----------------------------------------------------------------------------
+# Generates a program with STATEMENTS assignments nested DEPTH BEGIN/END levels
+# deep (each level indents the printed tree further), then reports the best of
+# RUNS wall times and the output size for parse-only (-j > /dev/null is the
+# floor) and -p.
+#
+# Usage: ./print_bench.sh [STATEMENTS] [DEPTH] [RUNS]  (PARSE_BIN overrides ./parse)
+# =============================================================================
+set -u
+. "$(dirname "$0")/bench_lib.sh"
+
+PARSE_BIN="${PARSE_BIN:-./parse}"
+STATEMENTS="${1:-100000}"
+DEPTH="${2:-20}"
+RUNS="${3:-1}"
+
+bench_tmpdir
+SRC="$TMP/big.tips"
+big_program "$STATEMENTS" "$DEPTH" > "$SRC"
+
+# measure LABEL FLAGS... — best wall seconds and bytes written to stdout
+measure() {
+  local label="$1"; shift
+  local t bytes
+  t=$(best_time "$RUNS" "$PARSE_BIN" "$@" "$SRC")
+  bytes=$("$PARSE_BIN" "$@" "$SRC" < /dev/null 2>/dev/null | wc -c)
+  awk -v l="$label" -v t="$t" -v b="$bytes" \
+    'BEGIN { printf "  %-4s %8.3f s  %12d bytes\n", l, t, b }'
+}
+
+echo "source: $(wc -c < "$SRC") bytes, $((STATEMENTS * 2)) assignments, depth $DEPTH"
+measure "-j" -j
+measure "-p" -p
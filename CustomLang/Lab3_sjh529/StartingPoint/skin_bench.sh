@@ -0,0 +1,38 @@
+#!/usr/bin/env bash
+# =============================================================================
+# skin_bench.sh — token-dump throughput on keyword-heavy input, per skin
+# -----------------------------------------------------------------------------
+# Builds `parse`, generates LINES lines of keywords and identifiers for each
+# skin, and reports MB/s for `-t > /dev/null` (scan only). Extra binaries to
+# compare on the default skin can be listed in EXTRA_BINS.
+#
+# Usage: ./skin_bench.sh [LINES] [RUNS]
+# =============================================================================
+set -u
+. "$(dirname "$0")/bench_lib.sh"
+
+LINES="${1:-200000}"
+RUNS="${2:-3}"
+
+make -s parse || exit 2
+
+bench_tmpdir
+yes "PROGRAM BEGIN END WRITE VAR INTEGER REAL READ MOD X1 COUNTER PROGRAMS" \
+  | head -n "$LINES" > "$TMP/default.tips"
+yes "VOYAGE AHOY AVAST SQUAWK CARGO DOUBLOON PIECES SPYGLASS SCUTTLE X1 COUNTER PROGRAMS" \
+  | head -n "$LINES" > "$TMP/pirate.tips"
+yes "KITTY PURR HISS MEOW TOYS WHISKERS CATNIP SNIFF SCRATCH X1 COUNTER PROGRAMS" \
+  | head -n "$LINES" > "$TMP/cat.tips"
+
+# best-of-RUNS wall time for BIN on SKIN, printed as seconds and MB/s
+bench() {
+  local bin="$1" skin="$2" src="$TMP/$2.tips" t size opt=()
+  size=$(wc -c < "$src")
+  [[ "$skin" != default ]] && opt=(--skin="$skin")   # older builds lack --skin
+  t=$(best_time "$RUNS" "$bin" "${opt[@]}" -t "$src")
+  printf "  %-16s %-8s %7.3f s  %7s MB/s\n" "$bin" "$skin" "$t" "$(mb_per_s "$size" "$t")"
+}
+
+echo "$LINES lines per skin, best of $RUNS"
+for skin in default pirate cat; do bench ./parse "$skin"; done
+for bin in ${EXTRA_BINS:-}; do bench "$bin" default; done
@@ -0,0 +1,169 @@
+// ============================================================================
+//  trace.h — Phase timing with Chrome trace-event export (--trace=FILE)
+// ----------------------------------------------------------------------------
+// MSU CSE 4714/6714 Capstone Project (Fall 2025)
+//
+//  What this is:
+//    Header-only span recorder. When the driver calls trace::start(path),
+//    every trace::Span records a complete ("ph":"X") event; at exit the
+//    events are written as Chrome trace-event JSON, which chrome://tracing,
+//    Perfetto and speedscope all open.
+//
+//  What gets recorded:
+//    • cat "phase" — driver phases (tokenize, parse, print, interpret)
+//    • cat "parse" — the top-level parse* functions
+//    • cat "lex"   — individual yylex() calls, up to kMaxLexSpans of them;
+//                    past that only the totals are kept. The totals are
+//                    written as a final "lex totals" instant event.
+//    • cat "interp" — each top-level statement of the program
+//
+//  Cost when off: each Span/Lex constructor is one well-predicted branch.
+//
+//  Quick usage:
+//      trace::Span s("parseBlock", "parse");
+//      s.arg("decls", n);              // optional, only stored when tracing
+//      { trace::Lex l; tok = yylex(); }
+// ============================================================================
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trace {
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Event {
+    const char* name;
+    const char* cat;
+    char ph;            // 'X' complete span, 'i' instant
+    double ts, dur;     // microseconds since start()
+    std::string args;   // body of the JSON args object (may be empty)
+  };
+
+  /// Process-wide recorder; the destructor writes the file at exit so every
+  /// return path out of main() (including errors) still produces a trace.
+  struct Recorder {
+    static constexpr size_t kMaxLexSpans = 100000;
+
+    bool on = false;
+    std::string path;
+    Clock::time_point t0;
+    std::vector<Event> events;
+    size_t lexCalls = 0;
+    double lexMicros = 0;
+
+    ~Recorder() { if (on) write(); }
+
+    double now() const {
+      return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+    }
+
+    void write() {
+      FILE* f = std::fopen(path.c_str(), "w");
+      if (!f) { std::perror(path.c_str()); return; }
+      events.push_back({"lex totals", "lex", 'i', now(), 0,
+                        "\"calls\":" + std::to_string(lexCalls) +
+                        ",\"total_us\":" + std::to_string(lexMicros) +
+                        ",\"recorded\":" + std::to_string(std::min(lexCalls, kMaxLexSpans))});
+      std::fputs("{\"traceEvents\":[\n", f);
+      std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+                 "\"args\":{\"name\":\"tips\"}}", f);
+      for (const Event& e : events) {
+        std::fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,",
+                     e.name, e.cat, e.ph, e.ts);
+        if (e.ph == 'X') std::fprintf(f, "\"dur\":%.3f,", e.dur);
+        else std::fputs("\"s\":\"p\",", f);
+        std::fprintf(f, "\"pid\":1,\"tid\":1,\"args\":{%s}}", e.args.c_str());
+      }
+      std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", f);
+      std::fclose(f);
+    }
+  };
+
+  inline Recorder& recorder() {
+    static Recorder r;
+    return r;
+  }
+
+  inline bool on() { return recorder().on; }
+
+  /// Enable recording; the trace is written to `path` when the program exits.
+  inline void start(const char* path) {
+    Recorder& r = recorder();
+    r.on = true;
+    r.path = path;
+    r.t0 = Clock::now();
+  }
+
+  /// RAII span: records [construction, destruction) when tracing is on.
+  /// `name` and `cat` must outlive the program (string literals, tokName()).
+  class Span {
+  public:
+    Span(const char* name, const char* cat) : name(name), cat(cat) {
+      if (on()) { active = true; start = recorder().now(); }
+    }
+    ~Span() {
+      if (!active) return;
+      Recorder& r = recorder();
+      r.events.push_back({name, cat, 'X', start, r.now() - start, std::move(args)});
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    void arg(const char* key, long long v) {
+      if (active) add(key) += std::to_string(v);
+    }
+    void arg(const char* key, std::string_view v) {
+      if (!active) return;
+      std::string& a = add(key);
+      a += '"';
+      for (char c : v) {
+        if (c == '"' || c == '\\') a += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) a += c;
+      }
+      a += '"';
+    }
+
+  private:
+    std::string& add(const char* key) {
+      if (!args.empty()) args += ',';
+      ((args += '"') += key) += "\":";
+      return args;
+    }
+
+    const char* name;
+    const char* cat;
+    bool active = false;
+    double start = 0;
+    std::string args;
+  };
+
+  /// Times one yylex() call; individual spans stop after kMaxLexSpans so a
+  /// large script cannot produce a trace the viewer refuses to open.
+  class Lex {
+  public:
+    Lex() {
+      if (on()) { active = true; start = recorder().now(); }
+    }
+    ~Lex() {
+      if (!active) return;
+      Recorder& r = recorder();
+      double end = r.now();
+      r.lexMicros += end - start;
+      if (r.lexCalls++ < Recorder::kMaxLexSpans)
+        r.events.push_back({"yylex", "lex", 'X', start, end - start, {}});
+    }
+    Lex(const Lex&) = delete;
+    Lex& operator=(const Lex&) = delete;
+
+  private:
+    bool active = false;
+    double start = 0;
+  };
+
+} // namespace trace
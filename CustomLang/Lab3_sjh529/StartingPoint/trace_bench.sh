@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+# =============================================================================
+# trace_bench.sh — parse throughput with tracing compiled in (off) vs. out
+# -----------------------------------------------------------------------------
+# Builds `parse` and `parse-notrace`, generates a program of STATEMENTS lines,
+# and reports MB/s for parse + JSON dump (-j > /dev/null; nothing interpreted)
+# with each binary. Extra binaries to compare can be listed in EXTRA_BINS.
+#
+# Usage: ./trace_bench.sh [STATEMENTS] [RUNS]
+# =============================================================================
+set -u
+. "$(dirname "$0")/bench_lib.sh"
+
+STATEMENTS="${1:-200000}"
+RUNS="${2:-3}"
+
+make -s parse parse-notrace || exit 2
+
+bench_tmpdir
+SRC="$TMP/big.tips"
+big_program "$STATEMENTS" > "$SRC"
+SIZE=$(wc -c < "$SRC")
+
+# best-of-RUNS wall time for BIN, printed as seconds and MB/s
+bench() {
+  local bin="$1" t
+  t=$(best_time "$RUNS" "$bin" -j "$SRC")
+  printf "  %-16s %7.3f s  %7s MB/s\n" "$bin" "$t" "$(mb_per_s "$SIZE" "$t")"
+}
+
+echo "source: $SIZE bytes, best of $RUNS"
+for bin in ./parse ./parse-notrace ${EXTRA_BINS:-}; do bench "$bin"; done